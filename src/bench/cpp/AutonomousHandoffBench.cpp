@@ -0,0 +1,84 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <array>
+#include <chrono>
+#include <string>
+
+#include "AutonomousChooser.hpp"
+#include "AutonomousMode.hpp"
+#include "Benchmark.hpp"
+
+namespace frc3512::bench {
+
+static constexpr size_t kWarmupCycles = 100;
+static constexpr size_t kCycles = 10000;
+
+// Waking another thread goes through the kernel scheduler, so it's budgeted
+// an order of magnitude more than a fiber switch. Both leave ample margin on
+// desktop machines; exceeding them means the handoff regressed.
+static constexpr std::chrono::microseconds kThreadBudget{200};
+static constexpr std::chrono::microseconds kFiberBudget{20};
+
+/**
+ * State shared with the trivial autonomous modes through the chooser's context
+ * pointer.
+ */
+struct BenchContext {
+    AutonomousChooser* chooser = nullptr;
+    bool running = true;
+};
+
+static void TrivialFunction(void* context) {
+    auto& bench = *static_cast<BenchContext*>(context);
+    while (bench.running) {
+        bench.chooser->YieldToMain();
+    }
+}
+
+static constexpr auto kModes = SortAutonomousModes(
+    std::array<AutonomousMode, 2>{{AutonomousMode{"Function", TrivialFunction},
+                                   AutonomousMode{"No-op", [](void*) {}}}});
+static_assert(HasUniqueNames(kModes), "Autonomous mode names must be unique");
+
+static bool RunHandoff(AutonomousChooser::Backend backend,
+                       const std::string& mode, const std::string& name,
+                       std::chrono::nanoseconds budget) {
+    BenchContext context;
+    AutonomousChooser chooser{&context, kModes, "No-op", backend};
+    context.chooser = &chooser;
+
+    LatencyRecorder recorder{kCycles};
+
+    chooser.SelectAutonomous(mode);
+    chooser.AwaitStartAutonomous();
+
+    for (size_t i = 0; i < kWarmupCycles; ++i) {
+        chooser.AwaitRunAutonomous();
+    }
+
+    int64_t startSwitches = GetContextSwitches();
+    for (size_t i = 0; i < kCycles; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        chooser.AwaitRunAutonomous();
+        recorder.Add(std::chrono::steady_clock::now() - start);
+    }
+    int64_t endSwitches = GetContextSwitches();
+
+    bool passed = recorder.Print(
+        name, startSwitches < 0 ? -1 : endSwitches - startSwitches, budget);
+
+    context.running = false;
+    chooser.EndAutonomous();
+
+    return passed;
+}
+
+bool RunAutonomousHandoffBench() {
+    bool passed = RunHandoff(AutonomousChooser::Backend::kThread, "Function",
+                             "handoff/thread", kThreadBudget);
+    passed &= RunHandoff(AutonomousChooser::Backend::kFiber, "Function",
+                         "handoff/fiber", kFiberBudget);
+    return passed;
+}
+
+}  // namespace frc3512::bench
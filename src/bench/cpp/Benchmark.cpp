@@ -0,0 +1,76 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "Benchmark.hpp"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+namespace frc3512::bench {
+
+// The robot's main loop period, used to report latency as a fraction of it
+static constexpr double kBudgetNs = 20e6;
+
+LatencyRecorder::LatencyRecorder(size_t capacity) {
+    m_samples.reserve(capacity);
+}
+
+void LatencyRecorder::Add(std::chrono::nanoseconds sample) {
+    m_samples.emplace_back(sample);
+}
+
+bool LatencyRecorder::Print(const std::string& name, int64_t contextSwitches,
+                            std::chrono::nanoseconds budget) const {
+    if (m_samples.empty()) {
+        return true;
+    }
+
+    auto sorted = m_samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto percentile = [&](double p) {
+        return static_cast<double>(
+            sorted[static_cast<size_t>(p * (sorted.size() - 1))].count());
+    };
+
+    double p50 = percentile(0.5);
+    double p99 = percentile(0.99);
+    double max = static_cast<double>(sorted.back().count());
+
+    std::printf("%-24s %8zu %10.0f %10.0f %10.0f %8.3f%%", name.c_str(),
+                sorted.size(), p50, p99, max, max / kBudgetNs * 100.0);
+    if (contextSwitches >= 0) {
+        std::printf(" %10.3f", static_cast<double>(contextSwitches) /
+                                   static_cast<double>(sorted.size()));
+    } else {
+        std::printf(" %10s", "n/a");
+    }
+
+    bool passed = p99 <= static_cast<double>(budget.count());
+    std::printf(" %12lld %s\n", static_cast<long long>(budget.count()),
+                passed ? "ok" : "FAIL");
+    return passed;
+}
+
+int64_t GetContextSwitches() {
+#ifdef _WIN32
+    return -1;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+}
+
+void PrintHeader() {
+    std::printf("%-24s %8s %10s %10s %10s %9s %10s %12s\n", "benchmark",
+                "samples", "p50 (ns)", "p99 (ns)", "max (ns)", "max/20ms",
+                "ctxsw/op", "budget (ns)");
+}
+
+}  // namespace frc3512::bench
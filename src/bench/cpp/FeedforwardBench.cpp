@@ -0,0 +1,69 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include <wpi/math>
+
+#include "Benchmark.hpp"
+#include "subsystems/Claw.hpp"
+
+namespace frc3512::bench {
+
+// A single evaluation is shorter than the clock's resolution, so each sample
+// times a batch and records the per-evaluation average
+static constexpr size_t kBatchSize = 1000;
+static constexpr size_t kSamples = 10000;
+
+// Per-evaluation budgets. The table lookup should stay well under std::cos().
+static constexpr std::chrono::nanoseconds kLibmBudget{200};
+static constexpr std::chrono::nanoseconds kTableBudget{50};
+
+// Keeps the compiler from optimizing the evaluations away
+static volatile double gSink;
+
+template <typename F>
+static bool RunFeedforward(const std::string& name,
+                           std::chrono::nanoseconds budget, F feedforward) {
+    LatencyRecorder recorder{kSamples};
+
+    // Sweep the claw's travel so table lookups don't all hit the same cache
+    // line
+    constexpr double kStep =
+        (Claw::kMaxFeedforwardAngle - Claw::kMinFeedforwardAngle) / kBatchSize;
+
+    for (size_t sample = 0; sample < kSamples; ++sample) {
+        double sum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kBatchSize; ++i) {
+            sum += feedforward(Claw::kMinFeedforwardAngle + i * kStep);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        gSink = sum;
+        recorder.Add((end - start) / kBatchSize);
+    }
+
+    return recorder.Print(name, -1, budget);
+}
+
+bool RunFeedforwardBench() {
+    constexpr double kReference = 115.0;
+
+    bool passed =
+        RunFeedforward("feedforward/libm", kLibmBudget, [](double angle) {
+            return Claw::kK *
+                   std::cos((angle + Claw::kL) * wpi::math::pi / 180.0) /
+                   kReference;
+        });
+
+    constexpr double kScale = Claw::kK / kReference;
+    passed &=
+        RunFeedforward("feedforward/table", kTableBudget, [](double angle) {
+            return kScale * Claw::FeedforwardCos(angle);
+        });
+    return passed;
+}
+
+}  // namespace frc3512::bench
@@ -0,0 +1,21 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <cstdio>
+
+#include <hal/HAL.h>
+
+#include "Benchmark.hpp"
+
+int main() {
+    HAL_Initialize(500, 0);
+
+    frc3512::bench::PrintHeader();
+    bool passed = frc3512::bench::RunAutonomousHandoffBench();
+    passed &= frc3512::bench::RunFeedforwardBench();
+
+    if (!passed) {
+        std::printf("A benchmark's p99 latency exceeded its budget\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace frc3512::bench {
+
+/**
+ * Collects latency samples and reports their distribution.
+ */
+class LatencyRecorder {
+public:
+    /**
+     * Constructs a LatencyRecorder.
+     *
+     * @param capacity Number of samples to preallocate storage for.
+     */
+    explicit LatencyRecorder(size_t capacity);
+
+    /**
+     * Adds a sample.
+     */
+    void Add(std::chrono::nanoseconds sample);
+
+    /**
+     * Prints the sample count, p50, p99, and max latency, the number of
+     * context switches per sample, and whether the p99 latency is within
+     * budget.
+     *
+     * @param name             Name of the benchmark.
+     * @param contextSwitches  Context switches made while collecting samples,
+     *                         or -1 if unknown.
+     * @param budget           Maximum p99 latency.
+     * @return True if the p99 latency is within budget.
+     */
+    bool Print(const std::string& name, int64_t contextSwitches,
+               std::chrono::nanoseconds budget) const;
+
+private:
+    std::vector<std::chrono::nanoseconds> m_samples;
+};
+
+/**
+ * Returns the number of voluntary and involuntary context switches the process
+ * has made so far, or -1 if the platform doesn't report them.
+ */
+int64_t GetContextSwitches();
+
+/**
+ * Prints the header for the table rows LatencyRecorder::Print() produces.
+ */
+void PrintHeader();
+
+/**
+ * Measures AutonomousChooser::AwaitRunAutonomous() round trips through a
+ * trivial autonomous mode for each execution backend.
+ *
+ * @return True if every backend was within budget.
+ */
+bool RunAutonomousHandoffBench();
+
+/**
+ * Measures the claw feedforward with std::cos() and with Claw's compile-time
+ * table.
+ *
+ * @return True if both were within budget.
+ */
+bool RunFeedforwardBench();
+
+}  // namespace frc3512::bench
@@ -3,97 +3,222 @@
 #include "AutonomousChooser.hpp"
 
 #include <algorithm>
+#include <string>
 
+#include <frc/DriverStation.h>
 #include <frc/smartdashboard/SmartDashboard.h>
 
 namespace frc3512 {
 
-AutonomousChooser::AutonomousChooser(wpi::StringRef name,
-                                     std::function<void()> func) {
-    m_defaultChoice = name;
-    m_choices[name] = func;
-    m_names.emplace_back(name);
+static wpi::StringRef ToStringRef(std::string_view str) {
+    return wpi::StringRef{str.data(), str.size()};
+}
+
+// Run in place of an empty table of autonomous modes
+static constexpr AutonomousMode kEmptyTableMode{"None", [](void*) {}};
+
+// Amount of the autonomous thread's stack to touch before it's parked
+static constexpr size_t kPrefaultStackSize = 256 * 1024;
+
+/**
+ * Touches the calling thread's stack so the page faults happen now instead of
+ * during the first autonomous cycle.
+ */
+static void PrefaultStack() {
+    volatile char stack[kPrefaultStackSize];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
 
-    m_selectedChoice = name;
-    m_selectedAuton = &m_choices[name];
+AutonomousChooser::AutonomousChooser(void* context,
+                                     wpi::ArrayRef<AutonomousMode> modes,
+                                     std::string_view defaultName,
+                                     Backend backend,
+                                     const ThreadSchedules& schedules)
+    : m_backend{backend},
+      m_context{context},
+      m_modes{modes},
+      m_listenerSchedule{schedules.listener} {
+    // The selected mode is always an index into m_modes, so it can't be empty
+    if (m_modes.empty()) {
+        frc::DriverStation::ReportError(
+            "AutonomousChooser: No autonomous modes were given");
+        m_modes = wpi::ArrayRef<AutonomousMode>{kEmptyTableMode};
+    }
+
+    // FindMode() falls back to m_defaultIndex, so the first autonomous mode is
+    // the default if defaultName isn't in the table
+    m_defaultIndex = 0;
+    m_defaultIndex = FindMode(defaultName);
+    if (m_modes[m_defaultIndex].name != defaultName) {
+        frc::DriverStation::ReportError(
+            "AutonomousChooser: Default autonomous mode \"" +
+            std::string{defaultName} + "\" isn't in the table");
+    }
+    m_selectedIndex = m_defaultIndex;
+    m_selectedAuton = &m_modes[m_defaultIndex];
 
     frc::SmartDashboard::PutData("Autonomous modes", this);
 
     m_selectedListenerHandle = m_selectedEntry.AddListener(
-        [=](const nt::EntryNotification& event) {
+        [this](const nt::EntryNotification& event) {
+            // The listener thread is owned by NetworkTables, so it can only be
+            // scheduled from a callback running on it
+            std::call_once(m_listenerScheduleFlag, [&] {
+                ApplyThreadSchedule("NT listener", m_listenerSchedule);
+            });
+
             if (!event.value->IsString()) {
                 return;
             }
 
-            {
-                std::scoped_lock lock{m_mutex};
-                m_selectedChoice = event.value->GetString();
-            }
+            // The name is resolved here so starting autonomous mode only has
+            // to load the index
+            auto name = event.value->GetString();
+            size_t index = FindMode(std::string_view{name.data(), name.size()});
+            m_selectedIndex = index;
 
-            m_activeEntry.SetString(m_selectedChoice);
+            m_activeEntry.SetString(ToStringRef(m_modes[index].name));
         },
         NT_NOTIFY_IMMEDIATE | NT_NOTIFY_NEW | NT_NOTIFY_UPDATE |
             NT_NOTIFY_LOCAL);
+
+    if (m_backend == Backend::kThread) {
+        m_autonThread = std::thread{[this] { RunAutonThread(); }};
+        ApplyThreadSchedule(m_autonThread, "autonomous", schedules.autonomous);
+
+#ifndef WPI_HAVE_PRIORITY_MUTEX
+        if (schedules.autonomous.priority > 0) {
+            frc::DriverStation::ReportWarning(
+                "AutonomousChooser: priority inheritance mutexes aren't "
+                "available on this platform");
+        }
+#endif
+    }
 }
 
 AutonomousChooser::~AutonomousChooser() {
     EndAutonomous();
     m_selectedEntry.RemoveListener(m_selectedListenerHandle);
-}
 
-void AutonomousChooser::AddAutonomous(wpi::StringRef name,
-                                      std::function<void()> func) {
-    m_choices[name] = func;
-    m_names.emplace_back(name);
-
-    // Unlike std::map, wpi::StringMap elements are not sorted
-    std::sort(m_names.begin(), m_names.end());
-
-    m_optionsEntry.SetStringArray(m_names);
+    if (m_autonThread.joinable()) {
+        m_exiting = true;
+        m_cond.notify_one();
+        m_mainLock.unlock();
+        m_autonThread.join();
+    }
 }
 
 void AutonomousChooser::SelectAutonomous(wpi::StringRef name) {
-    {
-        std::scoped_lock lock{m_mutex};
-        m_selectedChoice = name;
-    }
+    m_selectedIndex = FindMode(std::string_view{name.data(), name.size()});
     m_selectedEntry.SetString(name);
 }
 
-const std::vector<std::string>& AutonomousChooser::GetAutonomousNames() const {
-    return m_names;
+std::vector<std::string> AutonomousChooser::GetAutonomousNames() const {
+    std::vector<std::string> names;
+    for (const auto& mode : m_modes) {
+        names.emplace_back(mode.name);
+    }
+    return names;
 }
 
 void AutonomousChooser::YieldToMain() {
-    m_awaitingAuton = false;
-    m_cond.notify_one();
-    m_cond.wait(m_autonLock, [&] { return m_awaitingAuton; });
+    if (m_backend == Backend::kFiber) {
+        m_autonFiber->Suspend();
+    } else {
+        m_awaitingAuton = false;
+        m_cond.notify_one();
+        m_cond.wait(m_autonLock, [&] { return m_awaitingAuton; });
+    }
+
+    if (m_cancelling) {
+        throw Cancellation{};
+    }
+}
+
+void AutonomousChooser::Wait(units::second_t duration) {
+    auto endTime = frc2::Timer::GetFPGATimestamp() + duration;
+    while (frc2::Timer::GetFPGATimestamp() < endTime) {
+        YieldToMain();
+    }
 }
 
 void AutonomousChooser::Return() {
+    if (m_backend == Backend::kFiber) {
+        return;
+    }
+
     m_awaitingAuton = false;
     m_cond.notify_one();
 }
 
 void AutonomousChooser::AwaitStartAutonomous() {
-    {
-        std::scoped_lock lock{m_mutex};
-        m_selectedAuton = &m_choices[m_selectedChoice];
+    // A previous autonomous mode that's still running is unwound and its
+    // profile reported first, so its phases' scopes don't end in the new
+    // profile
+    EndAutonomous();
+
+    m_selectedAuton = &m_modes[m_selectedIndex];
+
+    m_profiler.Reset();
+    m_profilePending = true;
+
+    auto startTime = frc2::Timer::GetFPGATimestamp();
+    StartSelectedAuton();
+    CheckCycleBudget(startTime);
+}
+
+void AutonomousChooser::AwaitRunAutonomous() {
+    m_profiler.NextCycle();
+
+    auto startTime = frc2::Timer::GetFPGATimestamp();
+    RunSelectedAuton();
+    CheckCycleBudget(startTime);
+}
+
+PhaseProfiler::Scope AutonomousChooser::Phase(std::string_view name) {
+    return m_profiler.Phase(name);
+}
+
+void AutonomousChooser::SetCycleBudget(units::second_t budget) {
+    m_cycleBudget = budget;
+}
+
+int AutonomousChooser::GetCycleOverruns() const { return m_cycleOverruns; }
+
+void AutonomousChooser::StartSelectedAuton() {
+    m_cancelling = false;
+
+    if (m_backend == Backend::kFiber) {
+        auto func = [this] {
+            m_autonRunning = true;
+            RunSelectedFunc();
+            m_autonRunning = false;
+        };
+        if (m_autonFiber) {
+            m_autonFiber->Reset(func);
+        } else {
+            m_autonFiber = std::make_unique<Fiber>(func);
+        }
+        m_autonFiber->Resume();
+        return;
     }
 
+    // Wake the parked autonomous thread
     m_awaitingAuton = true;
-    m_autonThread = std::thread{[=] {
-        m_autonLock.lock();
-        m_autonRunning = true;
-        (*m_selectedAuton)();
-        m_autonRunning = false;
-        Return();
-        m_autonLock.unlock();
-    }};
+    m_cond.notify_one();
     m_cond.wait(m_mainLock, [&] { return !m_awaitingAuton; });
 }
 
-void AutonomousChooser::AwaitRunAutonomous() {
+void AutonomousChooser::RunSelectedAuton() {
+    if (m_backend == Backend::kFiber) {
+        if (m_autonRunning) {
+            m_autonFiber->Resume();
+        }
+        return;
+    }
+
     if (m_autonRunning) {
         m_awaitingAuton = true;
         m_cond.notify_one();
@@ -102,29 +227,125 @@ void AutonomousChooser::AwaitRunAutonomous() {
 }
 
 void AutonomousChooser::EndAutonomous() {
-    if (m_autonRunning) {
+    EndSelectedAuton();
+
+    // The phases are reported once all their scopes have ended
+    if (m_profilePending) {
+        m_profilePending = false;
+        if (!m_profiler.IsEmpty()) {
+            m_profiler.Print();
+            m_phaseNamesEntry.SetStringArray(m_profiler.GetNames());
+            m_phaseDurationsEntry.SetDoubleArray(m_profiler.GetDurations());
+            m_phaseCyclesEntry.SetDoubleArray(m_profiler.GetCycles());
+        }
+    }
+}
+
+void AutonomousChooser::EndSelectedAuton() {
+    if (!m_autonRunning) {
+        return;
+    }
+
+    // Resuming the autonomous mode makes YieldToMain() throw, which unwinds
+    // the autonomous mode function back to RunSelectedFunc()
+    m_cancelling = true;
+
+    if (m_backend == Backend::kFiber) {
+        m_autonFiber->Resume();
+    } else {
         m_awaitingAuton = true;
         m_cond.notify_one();
         m_cond.wait(m_mainLock, [&] { return !m_awaitingAuton; });
     }
-    if (m_autonThread.joinable()) {
-        m_autonThread.join();
-    }
 }
 
 void AutonomousChooser::InitSendable(frc::SendableBuilder& builder) {
     builder.SetSmartDashboardType("String Chooser");
 
-    builder.GetEntry("default").SetString(m_defaultChoice);
+    auto defaultName = ToStringRef(m_modes[m_defaultIndex].name);
+
+    builder.GetEntry("default").SetString(defaultName);
 
+    // The table is already sorted, so the options are published once here
     m_optionsEntry = builder.GetEntry("options");
-    m_optionsEntry.SetStringArray(m_names);
+    m_optionsEntry.SetStringArray(GetAutonomousNames());
 
     m_selectedEntry = builder.GetEntry("selected");
-    m_selectedEntry.SetString(m_defaultChoice);
+    m_selectedEntry.SetString(defaultName);
 
     m_activeEntry = builder.GetEntry("active");
-    m_activeEntry.SetString(m_defaultChoice);
+    m_activeEntry.SetString(defaultName);
+
+    m_overrunCountEntry = builder.GetEntry("overrun count");
+    m_overrunCountEntry.SetDouble(m_cycleOverruns);
+
+    m_overrunTimeEntry = builder.GetEntry("last overrun timestamp (s)");
+    m_overrunDurationEntry = builder.GetEntry("last overrun duration (s)");
+    m_overrunAutonEntry = builder.GetEntry("last overrun autonomous mode");
+
+    m_phaseNamesEntry = builder.GetEntry("phase names");
+    m_phaseDurationsEntry = builder.GetEntry("phase durations (s)");
+    m_phaseCyclesEntry = builder.GetEntry("phase cycles");
+}
+
+void AutonomousChooser::RunAutonThread() {
+    PrefaultStack();
+
+    m_autonLock.lock();
+    while (true) {
+        // Park until an autonomous mode is dispatched
+        m_cond.wait(m_autonLock, [&] { return m_awaitingAuton || m_exiting; });
+        if (m_exiting) {
+            break;
+        }
+
+        m_autonRunning = true;
+        RunSelectedFunc();
+        m_autonRunning = false;
+        Return();
+    }
+    m_autonLock.unlock();
+}
+
+void AutonomousChooser::RunSelectedFunc() {
+    try {
+        m_selectedAuton->func(m_context);
+    } catch (const Cancellation&) {
+    }
+}
+
+void AutonomousChooser::CheckCycleBudget(units::second_t startTime) {
+    auto endTime = frc2::Timer::GetFPGATimestamp();
+    auto duration = endTime - startTime;
+    if (duration <= m_cycleBudget) {
+        return;
+    }
+
+    ++m_cycleOverruns;
+
+    m_overrunCountEntry.SetDouble(m_cycleOverruns);
+    m_overrunTimeEntry.SetDouble(endTime.to<double>());
+    m_overrunDurationEntry.SetDouble(duration.to<double>());
+    m_overrunAutonEntry.SetString(ToStringRef(m_selectedAuton->name));
+
+    frc::DriverStation::ReportWarning(
+        "Autonomous mode '" + std::string{m_selectedAuton->name} +
+        "' ran for " + std::to_string(duration.to<double>() * 1000.0) +
+        " ms between yields, which is over its " +
+        std::to_string(m_cycleBudget.to<double>() * 1000.0) + " ms budget");
+}
+
+size_t AutonomousChooser::FindMode(std::string_view name) const {
+    auto mode = std::lower_bound(
+        m_modes.begin(), m_modes.end(), name,
+        [](const AutonomousMode& mode, std::string_view name) {
+            return mode.name < name;
+        });
+    if (mode != m_modes.end() && mode->name == name) {
+        return mode - m_modes.begin();
+    } else {
+        return m_defaultIndex;
+    }
 }
 
 }  // namespace frc3512
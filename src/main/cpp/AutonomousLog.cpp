@@ -0,0 +1,257 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "AutonomousLog.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+#include <frc/DriverStation.h>
+#include <wpi/raw_ostream.h>
+
+namespace frc3512 {
+
+static constexpr std::array<char, 8> kMagic = {'3', '5', '1', '2',
+                                               'A', 'U', 'T', 'O'};
+static constexpr uint32_t kVersion = 2;
+
+// 15 seconds of autonomous at 50 Hz with margin for loop overruns
+static constexpr size_t kFrameCapacity = 1000;
+
+// Outputs are stored as floats, so smaller differences aren't meaningful
+static constexpr double kOutputTolerance = 1e-4;
+
+// Size of a packed frame in the file
+static constexpr size_t kFrameSize = sizeof(double) + 6 * sizeof(float) + 1;
+
+/**
+ * Copies a value's bytes into the buffer and advances the buffer pointer.
+ */
+template <typename T>
+static void Pack(char*& buffer, T value) {
+    std::memcpy(buffer, &value, sizeof(T));
+    buffer += sizeof(T);
+}
+
+/**
+ * Copies a value's bytes out of the buffer and advances the buffer pointer.
+ */
+template <typename T>
+static void Unpack(const char*& buffer, T& value) {
+    std::memcpy(&value, buffer, sizeof(T));
+    buffer += sizeof(T);
+}
+
+/**
+ * Returns a path that no file exists at, named for the current time.
+ *
+ * @param prefix Path prefix of the file.
+ */
+static std::string MakeLogPath(std::string_view prefix) {
+    std::time_t now = std::time(nullptr);
+    char time[32];
+    std::strftime(time, sizeof(time), "-%Y%m%d-%H%M%S", std::localtime(&now));
+
+    std::string base = std::string{prefix} + time;
+    std::string path = base + ".bin";
+    for (int i = 1; std::ifstream{path}.good(); ++i) {
+        path = base + "-" + std::to_string(i) + ".bin";
+    }
+    return path;
+}
+
+AutonomousRecorder::AutonomousRecorder() {
+    m_frames.reserve(kFrameCapacity);
+    m_savingFrames.reserve(kFrameCapacity);
+    m_writerThread = std::thread{[this] { RunWriterThread(); }};
+}
+
+AutonomousRecorder::~AutonomousRecorder() {
+    {
+        std::scoped_lock lock{m_writerMutex};
+        m_exiting = true;
+    }
+    m_writerCond.notify_all();
+    m_writerThread.join();
+}
+
+void AutonomousRecorder::Clear() { m_frames.clear(); }
+
+void AutonomousRecorder::Record(const AutonomousFrame& frame) {
+    if (m_frames.size() < kFrameCapacity) {
+        m_frames.emplace_back(frame);
+    }
+}
+
+const std::vector<AutonomousFrame>& AutonomousRecorder::GetFrames() const {
+    return m_frames;
+}
+
+bool AutonomousRecorder::Save(const std::string& path) const {
+    return Write(path, m_frames);
+}
+
+void AutonomousRecorder::SaveInBackground(std::string_view prefix) {
+    {
+        std::scoped_lock lock{m_writerMutex};
+        if (!m_savePending) {
+            // Both buffers have the full capacity reserved, so swapping them
+            // doesn't allocate
+            std::swap(m_frames, m_savingFrames);
+            m_savePrefix = prefix;
+            m_savePending = true;
+        }
+    }
+    m_writerCond.notify_all();
+
+    if (!m_frames.empty()) {
+        frc::DriverStation::ReportError(
+            "Autonomous log discarded because the previous one is still being "
+            "saved");
+    }
+    m_frames.clear();
+}
+
+std::string AutonomousRecorder::WaitForSave() {
+    std::unique_lock<wpi::mutex> lock{m_writerMutex};
+    m_writerCond.wait(lock, [this] { return !m_savePending; });
+    return m_lastSavedPath;
+}
+
+void AutonomousRecorder::RunWriterThread() {
+    std::unique_lock<wpi::mutex> lock{m_writerMutex};
+    while (true) {
+        m_writerCond.wait(lock, [this] { return m_savePending || m_exiting; });
+        if (!m_savePending) {
+            break;
+        }
+
+        // The frames and prefix aren't touched by other threads while a save
+        // is pending, so the lock isn't held during the write
+        lock.unlock();
+        std::string path = MakeLogPath(m_savePrefix);
+        bool saved = Write(path, m_savingFrames);
+        m_savingFrames.clear();
+        if (!saved) {
+            frc::DriverStation::ReportError("Failed to save autonomous log '" +
+                                            path + "'");
+        }
+        lock.lock();
+
+        if (saved) {
+            m_lastSavedPath = path;
+        }
+        m_savePending = false;
+        m_writerCond.notify_all();
+    }
+}
+
+bool AutonomousRecorder::Write(const std::string& path,
+                               const std::vector<AutonomousFrame>& frames) {
+    std::vector<char> buffer(kMagic.size() + 2 * sizeof(uint32_t) +
+                             frames.size() * kFrameSize);
+    char* pos = buffer.data();
+
+    std::memcpy(pos, kMagic.data(), kMagic.size());
+    pos += kMagic.size();
+    Pack(pos, kVersion);
+    Pack(pos, static_cast<uint32_t>(frames.size()));
+
+    for (const auto& frame : frames) {
+        Pack(pos, frame.timestamp);
+        Pack(pos, frame.leftDist);
+        Pack(pos, frame.rightDist);
+        Pack(pos, frame.batteryVoltage);
+        Pack(pos, frame.flags);
+        Pack(pos, frame.leftOutput);
+        Pack(pos, frame.rightOutput);
+        Pack(pos, frame.clawReference);
+    }
+
+    std::ofstream file{path, std::ios::binary};
+    file.write(buffer.data(), buffer.size());
+    return file.good();
+}
+
+std::vector<AutonomousFrame> AutonomousRecorder::Load(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+    std::vector<char> buffer{std::istreambuf_iterator<char>{file},
+                             std::istreambuf_iterator<char>{}};
+
+    constexpr size_t kHeaderSize = kMagic.size() + 2 * sizeof(uint32_t);
+    if (buffer.size() < kHeaderSize ||
+        !std::equal(kMagic.begin(), kMagic.end(), buffer.begin())) {
+        return {};
+    }
+
+    const char* pos = buffer.data() + kMagic.size();
+    uint32_t version;
+    uint32_t count;
+    Unpack(pos, version);
+    Unpack(pos, count);
+    if (version != kVersion ||
+        buffer.size() != kHeaderSize + count * kFrameSize) {
+        return {};
+    }
+
+    std::vector<AutonomousFrame> frames(count);
+    for (auto& frame : frames) {
+        Unpack(pos, frame.timestamp);
+        Unpack(pos, frame.leftDist);
+        Unpack(pos, frame.rightDist);
+        Unpack(pos, frame.batteryVoltage);
+        Unpack(pos, frame.flags);
+        Unpack(pos, frame.leftOutput);
+        Unpack(pos, frame.rightOutput);
+        Unpack(pos, frame.clawReference);
+    }
+    return frames;
+}
+
+void AutonomousReplayResult::Compare(size_t index,
+                                     const AutonomousFrame& recorded,
+                                     const AutonomousFrame& replayed) {
+    ++frames;
+
+    double error = std::max(
+        {std::abs(recorded.leftOutput - replayed.leftOutput),
+         std::abs(recorded.rightOutput - replayed.rightOutput),
+         std::abs(recorded.clawReference - replayed.clawReference)});
+    maxOutputError = std::max(maxOutputError, error);
+
+    bool shootingMatches = (recorded.flags & AutonomousFrame::kClawShooting) ==
+                           (replayed.flags & AutonomousFrame::kClawShooting);
+    if (error > kOutputTolerance || !shootingMatches) {
+        ++mismatchedFrames;
+        if (!firstMismatch) {
+            firstMismatch = index;
+        }
+    }
+}
+
+void AutonomousReplayResult::Print() const {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-24s %12zu\n", "frames replayed",
+                  frames);
+    wpi::outs() << line;
+    std::snprintf(line, sizeof(line), "%-24s %12zu\n", "mismatched frames",
+                  mismatchedFrames);
+    wpi::outs() << line;
+    if (firstMismatch) {
+        std::snprintf(line, sizeof(line), "%-24s %12zu\n", "first mismatch",
+                      *firstMismatch);
+        wpi::outs() << line;
+    }
+    std::snprintf(line, sizeof(line), "%-24s %12.6f\n", "max output error",
+                  maxOutputError);
+    wpi::outs() << line;
+}
+
+}  // namespace frc3512
@@ -0,0 +1,138 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+// macOS only declares the ucontext functions when _XOPEN_SOURCE is defined
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 600
+#endif
+
+#include "Fiber.hpp"
+
+// windows.h defines Yield() as a macro, so Fiber can't have a member by that
+// name
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ucontext.h>
+#endif
+
+#include <cstdint>
+#include <utility>
+
+#if defined(__APPLE__)
+// The ucontext functions are deprecated on macOS but still work
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+namespace frc3512 {
+
+#ifdef _WIN32
+
+struct Fiber::Context {
+    LPVOID fiber = nullptr;
+    LPVOID caller = nullptr;
+};
+
+Fiber::Fiber(std::function<void()> func, size_t stackSize)
+    : m_func{std::move(func)}, m_context{std::make_unique<Context>()} {
+    m_context->fiber = CreateFiber(
+        stackSize,
+        [](LPVOID param) { Entry(static_cast<Fiber*>(param)); }, this);
+}
+
+Fiber::~Fiber() { DeleteFiber(m_context->fiber); }
+
+void Fiber::Resume() {
+    if (m_done) {
+        return;
+    }
+
+    // Only fibers can switch to other fibers, so the calling thread is
+    // converted on first use and stays a fiber afterward
+    if (IsThreadAFiber()) {
+        m_context->caller = GetCurrentFiber();
+    } else {
+        m_context->caller = ConvertThreadToFiber(nullptr);
+    }
+    SwitchToFiber(m_context->fiber);
+
+    if (m_exception) {
+        std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+}
+
+void Fiber::Suspend() { SwitchToFiber(m_context->caller); }
+
+#else
+
+struct Fiber::Context {
+    ucontext_t fiber;
+    ucontext_t caller;
+    std::unique_ptr<char[]> stack;
+};
+
+Fiber::Fiber(std::function<void()> func, size_t stackSize)
+    : m_func{std::move(func)}, m_context{std::make_unique<Context>()} {
+    // make_unique<char[]>() would zero-fill the whole stack
+    m_context->stack.reset(new char[stackSize]);
+
+    getcontext(&m_context->fiber);
+    m_context->fiber.uc_stack.ss_sp = m_context->stack.get();
+    m_context->fiber.uc_stack.ss_size = stackSize;
+
+    // makecontext() only passes int arguments, so the pointer to this instance
+    // is split into two halves
+    auto ptr = reinterpret_cast<uintptr_t>(this);
+    makecontext(&m_context->fiber,
+                reinterpret_cast<void (*)()>(
+                    +[](uint32_t high, uint32_t low) {
+                        Entry(reinterpret_cast<Fiber*>(static_cast<uintptr_t>(
+                            (static_cast<uint64_t>(high) << 32) | low)));
+                    }),
+                2, static_cast<uint32_t>(static_cast<uint64_t>(ptr) >> 32),
+                static_cast<uint32_t>(ptr));
+}
+
+Fiber::~Fiber() = default;
+
+void Fiber::Resume() {
+    if (m_done) {
+        return;
+    }
+
+    swapcontext(&m_context->caller, &m_context->fiber);
+
+    if (m_exception) {
+        std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+}
+
+void Fiber::Suspend() { swapcontext(&m_context->fiber, &m_context->caller); }
+
+#endif
+
+void Fiber::Reset(std::function<void()> func) {
+    m_func = std::move(func);
+    m_exception = nullptr;
+    m_done = false;
+}
+
+bool Fiber::IsDone() const { return m_done; }
+
+void Fiber::Entry(Fiber* fiber) {
+    // The entry point never returns. Once the function is done, the fiber
+    // parks here until Reset() gives it another one, which lets it be reused
+    // without setting up a new stack.
+    while (true) {
+        // Exceptions can't unwind past the bottom of the fiber's stack, so
+        // they're handed to Resume() instead
+        try {
+            fiber->m_func();
+        } catch (...) {
+            fiber->m_exception = std::current_exception();
+        }
+        fiber->m_done = true;
+        fiber->Suspend();
+    }
+}
+
+}  // namespace frc3512
@@ -0,0 +1,117 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "LoopTimer.hpp"
+
+#include <algorithm>
+
+#include <frc/smartdashboard/SmartDashboard.h>
+
+namespace frc3512 {
+
+/**
+ * Converts a duration to seconds.
+ */
+static units::second_t ToSeconds(std::chrono::nanoseconds duration) {
+    return units::second_t{std::chrono::duration<double>{duration}.count()};
+}
+
+void LoopTimingHistogram::Record(std::chrono::nanoseconds duration) {
+    auto ns = std::max<int64_t>(duration.count(), 0);
+    auto bucket = std::min<size_t>(ns / kBucketWidth.count(), kBuckets);
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    int64_t max = m_max.load(std::memory_order_relaxed);
+    while (ns > max && !m_max.compare_exchange_weak(
+                           max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+LoopTimingHistogram::Snapshot LoopTimingHistogram::TakeSnapshot() {
+    // Samples recorded while the buckets are being drained land in either this
+    // snapshot or the next one, so none are lost
+    std::array<uint32_t, kBuckets + 1> counts;
+    uint32_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Snapshot snapshot;
+    snapshot.count = total;
+    snapshot.max = ToSeconds(std::chrono::nanoseconds{
+        m_max.exchange(0, std::memory_order_relaxed)});
+    if (total == 0) {
+        return snapshot;
+    }
+
+    // Returns the upper edge of the bucket containing the given percentile.
+    // The overflow bucket has no upper edge, so the maximum is used instead.
+    auto percentile = [&](double p) {
+        auto rank = static_cast<uint32_t>(p * (total - 1)) + 1;
+        uint32_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(ToSeconds((i + 1) * kBucketWidth),
+                                snapshot.max);
+            }
+        }
+        return snapshot.max;
+    };
+
+    snapshot.p50 = percentile(0.50);
+    snapshot.p95 = percentile(0.95);
+    snapshot.p99 = percentile(0.99);
+    return snapshot;
+}
+
+LoopTimer::Scope::~Scope() {
+    auto duration = std::chrono::steady_clock::now() - m_startTime;
+    m_timer->m_histogram.Record(duration);
+    if (duration > m_timer->m_period) {
+        m_timer->m_overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+LoopTimer::Scope::Scope(LoopTimer* timer)
+    : m_timer{timer}, m_startTime{std::chrono::steady_clock::now()} {}
+
+LoopTimer::LoopTimer(std::string_view name, units::second_t period)
+    : m_name{name},
+      m_period{std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>{period.to<double>()})} {}
+
+LoopTimer::Scope LoopTimer::Time() { return Scope{this}; }
+
+void LoopTimer::Publish() {
+    if (!m_isPublished) {
+        frc::SmartDashboard::PutData("Loop timing/" + m_name, this);
+        m_isPublished = true;
+    }
+
+    auto snapshot = m_histogram.TakeSnapshot();
+
+    m_countEntry.SetDouble(snapshot.count);
+    m_overrunsEntry.SetDouble(GetOverruns());
+    if (snapshot.count > 0) {
+        m_p50Entry.SetDouble(snapshot.p50.to<double>());
+        m_p95Entry.SetDouble(snapshot.p95.to<double>());
+        m_p99Entry.SetDouble(snapshot.p99.to<double>());
+        m_maxEntry.SetDouble(snapshot.max.to<double>());
+    }
+}
+
+uint32_t LoopTimer::GetOverruns() const {
+    return m_overruns.load(std::memory_order_relaxed);
+}
+
+void LoopTimer::InitSendable(frc::SendableBuilder& builder) {
+    m_countEntry = builder.GetEntry("count");
+    m_overrunsEntry = builder.GetEntry("overruns");
+    m_p50Entry = builder.GetEntry("p50 (s)");
+    m_p95Entry = builder.GetEntry("p95 (s)");
+    m_p99Entry = builder.GetEntry("p99 (s)");
+    m_maxEntry = builder.GetEntry("max (s)");
+}
+
+}  // namespace frc3512
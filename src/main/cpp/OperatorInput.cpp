@@ -0,0 +1,38 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "OperatorInput.hpp"
+
+#include <algorithm>
+
+namespace frc3512 {
+
+void OperatorInput::Update() {
+    for (int port = 0; port < kJoysticks; ++port) {
+        auto& joystick = m_joysticks[port];
+
+        // A disconnected joystick reads as zero axes and no buttons
+        HAL_JoystickAxes axes{};
+        HAL_GetJoystickAxes(port, &axes);
+        HAL_JoystickButtons buttons{};
+        HAL_GetJoystickButtons(port, &buttons);
+
+        joystick.axes.fill(0.f);
+        std::copy_n(axes.axes,
+                    std::clamp<int>(axes.count, 0, joystick.axes.size()),
+                    joystick.axes.begin());
+
+        uint32_t previous = joystick.buttons;
+        joystick.buttons = buttons.buttons;
+        joystick.pressed = buttons.buttons & ~previous;
+        joystick.released = ~buttons.buttons & previous;
+    }
+}
+
+const JoystickSnapshot& OperatorInput::GetJoystick(int port) const {
+    if (port < 0 || port >= kJoysticks) {
+        return m_empty;
+    }
+    return m_joysticks[port];
+}
+
+}  // namespace frc3512
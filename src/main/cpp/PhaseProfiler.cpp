@@ -0,0 +1,110 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "PhaseProfiler.hpp"
+
+#include <cstdio>
+
+#include <frc2/Timer.h>
+#include <wpi/raw_ostream.h>
+
+namespace frc3512 {
+
+PhaseProfiler::Scope::~Scope() { m_profiler->EndPhase(m_index); }
+
+PhaseProfiler::Scope::Scope(PhaseProfiler* profiler, size_t index)
+    : m_profiler{profiler}, m_index{index} {}
+
+PhaseProfiler::Scope PhaseProfiler::Phase(std::string_view name) {
+    if (m_size == kMaxPhases) {
+        ++m_dropped;
+        ++m_depth;
+        return Scope{this, kMaxPhases};
+    }
+
+    auto& record = m_records[m_size];
+    record.name = name;
+    record.depth = m_depth;
+    record.startTime = frc2::Timer::GetFPGATimestamp();
+    record.endTime = record.startTime;
+    record.startCycle = m_cycle;
+    record.endCycle = m_cycle;
+
+    ++m_depth;
+    return Scope{this, m_size++};
+}
+
+void PhaseProfiler::NextCycle() { ++m_cycle; }
+
+void PhaseProfiler::Reset() {
+    m_size = 0;
+    m_dropped = 0;
+    m_depth = 0;
+    m_cycle = 0;
+}
+
+bool PhaseProfiler::IsEmpty() const { return m_size == 0; }
+
+void PhaseProfiler::Print() const {
+    auto names = GetNames();
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-40s %12s %8s\n", "phase",
+                  "duration (s)", "cycles");
+    wpi::outs() << line;
+
+    for (size_t i = 0; i < m_size; ++i) {
+        const auto& record = m_records[i];
+        std::snprintf(line, sizeof(line), "%-40s %12.3f %8u\n",
+                      names[i].c_str(),
+                      (record.endTime - record.startTime).to<double>(),
+                      record.endCycle - record.startCycle);
+        wpi::outs() << line;
+    }
+
+    if (m_dropped > 0) {
+        wpi::outs() << m_dropped << " phases weren't recorded\n";
+    }
+}
+
+std::vector<std::string> PhaseProfiler::GetNames() const {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < m_size; ++i) {
+        const auto& record = m_records[i];
+        names.emplace_back(std::string(record.depth * 2, ' ') +
+                           std::string{record.name});
+    }
+    return names;
+}
+
+std::vector<double> PhaseProfiler::GetDurations() const {
+    std::vector<double> durations;
+    for (size_t i = 0; i < m_size; ++i) {
+        const auto& record = m_records[i];
+        durations.emplace_back(
+            (record.endTime - record.startTime).to<double>());
+    }
+    return durations;
+}
+
+std::vector<double> PhaseProfiler::GetCycles() const {
+    std::vector<double> cycles;
+    for (size_t i = 0; i < m_size; ++i) {
+        const auto& record = m_records[i];
+        cycles.emplace_back(record.endCycle - record.startCycle);
+    }
+    return cycles;
+}
+
+void PhaseProfiler::EndPhase(size_t index) {
+    --m_depth;
+
+    if (index == kMaxPhases) {
+        return;
+    }
+
+    auto& record = m_records[index];
+    record.endTime = frc2::Timer::GetFPGATimestamp();
+    record.endCycle = m_cycle;
+}
+
+}  // namespace frc3512
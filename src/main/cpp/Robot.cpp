@@ -2,32 +2,271 @@
 
 #include "Robot.hpp"
 
-Robot::Robot() {
-    m_autonChooser.AddAutonomous("DriveForward Autonomous",
-                                 [=] { AutonDriveForward(); });
-    m_autonChooser.AddAutonomous("Right/Left Autonomous",
-                                 [=] { AutonRightLeft(); });
-    m_autonChooser.AddAutonomous("Side Auton", [=] { AutonSide(); });
+#include <array>
+#include <string_view>
+
+#include <frc/DriverStation.h>
+#include <frc/RobotBase.h>
+#include <frc/RobotController.h>
+#include <frc/simulation/DriverStationSim.h>
+#include <frc/simulation/RoboRioSim.h>
+#include <frc/simulation/SimHooks.h>
+#include <hal/HAL.h>
+
+static constexpr auto kAutonomousModes = frc3512::SortAutonomousModes(
+    std::array<frc3512::AutonomousMode, 4>{
+        {frc3512::AutonomousMode{"No-op", [](void*) {}},
+         frc3512::MakeAutonomousMode<&Robot::AutonDriveForward>(
+             "DriveForward Autonomous"),
+         frc3512::MakeAutonomousMode<&Robot::AutonRightLeft>(
+             "Right/Left Autonomous"),
+         frc3512::MakeAutonomousMode<&Robot::AutonSide>("Side Auton")}});
+static_assert(frc3512::HasUniqueNames(kAutonomousModes),
+              "Autonomous mode names must be unique");
+
+static constexpr std::string_view kDefaultAutonomousMode = "No-op";
+static_assert(frc3512::HasMode(kAutonomousModes, kDefaultAutonomousMode),
+              "The default autonomous mode must be in the table");
+
+Robot::Robot()
+    : m_autonChooser{this,
+                     kAutonomousModes,
+                     kDefaultAutonomousMode,
+                     // Handing off to a fiber each cycle is a stack switch on
+                     // the main thread rather than two thread wakeups
+                     frc3512::AutonomousChooser::Backend::kFiber,
+                     {OnRobot(kAutonThreadSchedule),
+                      OnRobot(kListenerThreadSchedule)}} {
+    AddPeriodic(
+        [this] {
+            m_robotPeriodicTimer.Publish();
+            m_autonomousPeriodicTimer.Publish();
+            m_teleopPeriodicTimer.Publish();
+            m_testPeriodicTimer.Publish();
+            m_claw.PublishLoopTiming();
+        },
+        1_s, kLoopTimingOffset);
+
+    frc3512::StartupProfiler::Mark("Robot constructor");
 }
 
-void Robot::DisabledInit() { m_autonChooser.EndAutonomous(); }
+void Robot::StartCompetition() {
+    // The main loop runs on whichever thread calls this, which isn't
+    // necessarily the one that constructed Robot
+    if (frc::RobotBase::IsReal()) {
+        frc3512::ApplyThreadSchedule("main", kMainThreadSchedule);
+    }
 
-void Robot::AutonomousInit() { m_autonChooser.AwaitStartAutonomous(); }
+    frc::TimedRobot::StartCompetition();
+}
 
-void Robot::TeleopInit() { m_autonChooser.EndAutonomous(); }
+void Robot::DisabledInit() {
+    m_autonChooser.EndAutonomous();
+    m_drivetrain.DisableController();
+    SaveAutonomousLog();
+    m_claw.StopTest();
+}
 
-void Robot::TestInit() { m_autonChooser.EndAutonomous(); }
+void Robot::AutonomousInit() {
+    m_autonRecorder.Clear();
 
-void Robot::RobotPeriodic() { m_claw.RobotPeriodic(); }
+    auto frame = SampleAutonomousInputs();
+    m_autonChooser.AwaitStartAutonomous();
+    m_drivetrain.ControllerPeriodic();
+    SampleAutonomousOutputs(frame);
+    m_autonRecorder.Record(frame);
+}
+
+void Robot::TeleopInit() {
+    m_autonChooser.EndAutonomous();
+    m_drivetrain.DisableController();
+    SaveAutonomousLog();
+}
 
-void Robot::AutonomousPeriodic() { m_autonChooser.AwaitRunAutonomous(); }
+void Robot::TestInit() {
+    m_autonChooser.EndAutonomous();
+    m_drivetrain.DisableController();
+    SaveAutonomousLog();
+    m_claw.StartTest();
+}
+
+void Robot::RobotPeriodic() {
+    {
+        auto timing = m_robotPeriodicTimer.Time();
+        m_claw.RobotPeriodic(m_input);
+    }
 
-void Robot::TeleopPeriodic() { m_drivetrain.TeleopPeriodic(); }
+    if (m_isFirstLoop) {
+        frc3512::StartupProfiler::Mark("first loop");
+        frc3512::StartupProfiler::Print();
+        m_isFirstLoop = false;
+    }
+}
 
-void Robot::TestPeriodic() { m_claw.TestClaw(); }
+void Robot::DisabledPeriodic() { m_input.Update(); }
+
+void Robot::AutonomousPeriodic() {
+    auto timing = m_autonomousPeriodicTimer.Time();
+    m_input.Update();
+
+    auto frame = SampleAutonomousInputs();
+    m_autonChooser.AwaitRunAutonomous();
+    m_drivetrain.ControllerPeriodic();
+    SampleAutonomousOutputs(frame);
+    m_autonRecorder.Record(frame);
+}
+
+void Robot::TeleopPeriodic() {
+    auto timing = m_teleopPeriodicTimer.Time();
+    m_input.Update();
+    m_drivetrain.TeleopPeriodic(m_input);
+}
+
+void Robot::TestPeriodic() {
+    auto timing = m_testPeriodicTimer.Time();
+    m_input.Update();
+    m_claw.TestPeriodic();
+}
+
+void Robot::SimulationPeriodic() {
+    m_drivetrain.SimulationPeriodic(GetPeriod());
+}
 
 bool Robot::CheckReflectiveStrips() { return true; }
 
+void Robot::SelectAutonomous(std::string_view name) {
+    m_autonChooser.SelectAutonomous(wpi::StringRef{name.data(), name.size()});
+}
+
+const Drivetrain& Robot::GetDrivetrain() const { return m_drivetrain; }
+
+const Claw& Robot::GetClaw() const { return m_claw; }
+
+std::string Robot::WaitForAutonomousLog() {
+    return m_autonRecorder.WaitForSave();
+}
+
+frc3512::AutonomousReplayResult Robot::ReplayAutonomous(
+    std::string_view modeName, const std::string& path) {
+    frc3512::AutonomousReplayResult result;
+
+    auto frames = frc3512::AutonomousRecorder::Load(path);
+    if (frames.empty()) {
+        frc::DriverStation::ReportError("Failed to load autonomous log '" +
+                                        path + "'");
+        return result;
+    }
+
+    frc::sim::PauseTiming();
+    auto batteryVoltage = frc::sim::RoboRioSim::GetVInVoltage();
+    SelectAutonomous(modeName);
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const auto& recorded = frames[i];
+
+        // Reproduce the recorded cycle's timestamp, sensor readings, battery
+        // voltage, and driver station state. Stepping simulated time also
+        // runs the claw controller's Notifier, so stepping to the recorded
+        // timestamps rather than by their differences keeps it in the same
+        // phase as the recording when the robot was started at the same
+        // time.
+        auto dt = units::second_t{recorded.timestamp} -
+                  frc2::Timer::GetFPGATimestamp();
+        if (dt > 0_s) {
+            frc::sim::StepTiming(dt);
+        }
+        m_drivetrain.SetSimulatedDistances(units::inch_t{recorded.leftDist},
+                                           units::inch_t{recorded.rightDist});
+        frc::sim::RoboRioSim::SetVInVoltage(
+            units::volt_t{recorded.batteryVoltage});
+        bool enabled =
+            recorded.flags & frc3512::AutonomousFrame::kAutonomousEnabled;
+        frc::sim::DriverStationSim::SetAutonomous(enabled);
+        frc::sim::DriverStationSim::SetEnabled(enabled);
+        frc::sim::DriverStationSim::NotifyNewData();
+
+        // Like AutonomousPeriodic(), take a fresh snapshot so the claw
+        // doesn't see button edges left over from before the replay again
+        m_input.Update();
+
+        auto replayed = SampleAutonomousInputs();
+        if (i == 0) {
+            m_autonChooser.AwaitStartAutonomous();
+        } else {
+            m_autonChooser.AwaitRunAutonomous();
+        }
+        m_drivetrain.ControllerPeriodic();
+        SampleAutonomousOutputs(replayed);
+        m_claw.RobotPeriodic(m_input);
+
+        result.Compare(i, recorded, replayed);
+    }
+
+    m_autonChooser.EndAutonomous();
+    m_drivetrain.DisableController();
+    frc::sim::RoboRioSim::SetVInVoltage(batteryVoltage);
+    frc::sim::DriverStationSim::SetAutonomous(false);
+    frc::sim::DriverStationSim::SetEnabled(false);
+    frc::sim::DriverStationSim::NotifyNewData();
+    frc::sim::ResumeTiming();
+
+    return result;
+}
+
+frc3512::ThreadSchedule Robot::OnRobot(
+    const frc3512::ThreadSchedule& schedule) {
+    if (frc::RobotBase::IsReal()) {
+        return schedule;
+    }
+    return frc3512::ThreadSchedule{};
+}
+
+frc3512::AutonomousFrame Robot::SampleAutonomousInputs() {
+    frc3512::AutonomousFrame frame;
+    frame.timestamp = frc2::Timer::GetFPGATimestamp().to<double>();
+    frame.leftDist = m_drivetrain.GetLeftDist().to<double>();
+    frame.rightDist = m_drivetrain.GetRightDist().to<double>();
+    frame.batteryVoltage = frc::RobotController::GetInputVoltage();
+    if (IsAutonomousEnabled()) {
+        frame.flags |= frc3512::AutonomousFrame::kAutonomousEnabled;
+    }
+    if (m_claw.IsShooting()) {
+        frame.flags |= frc3512::AutonomousFrame::kClawShooting;
+    }
+    return frame;
+}
+
+void Robot::SampleAutonomousOutputs(frc3512::AutonomousFrame& frame) {
+    frame.leftOutput = m_drivetrain.GetLeftOutput();
+    frame.rightOutput = m_drivetrain.GetRightOutput();
+    frame.clawReference = m_claw.GetAngleReference().to<double>();
+}
+
+void Robot::SaveAutonomousLog() {
+    if (m_autonRecorder.GetFrames().empty()) {
+        return;
+    }
+
+    // This runs at the start of the next mode, so the file is written on the
+    // recorder's thread instead of stalling the main loop
+    m_autonRecorder.SaveInBackground(frc::RobotBase::IsReal()
+                                         ? "/home/lvuser/autonomous"
+                                         : "autonomous");
+}
+
 #ifndef RUNNING_FRC_TESTS
-int main() { return frc::StartRobot<Robot>(); }
+int main(int argc, char* argv[]) {
+    // "--replay <mode> <log>" replays a recorded autonomous mode in desktop
+    // simulation instead of running the robot
+    if (argc == 4 && std::string_view{argv[1]} == "--replay") {
+        HAL_Initialize(500, 0);
+        Robot robot;
+        auto result = robot.ReplayAutonomous(argv[2], argv[3]);
+        result.Print();
+        return result.frames > 0 && result.mismatchedFrames == 0 ? 0 : 1;
+    }
+
+    frc3512::StartupProfiler::Mark("load and static init");
+    return frc::StartRobot<Robot>();
+}
 #endif
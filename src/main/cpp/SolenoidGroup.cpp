@@ -0,0 +1,184 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "SolenoidGroup.hpp"
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include <frc/DriverStation.h>
+#include <frc/SensorUtil.h>
+#include <hal/HALBase.h>
+#include <hal/Solenoid.h>
+#include <wpi/mutex.h>
+
+namespace frc3512 {
+
+/**
+ * Commanded solenoid states of one PCM, shared by every SolenoidGroup on it.
+ */
+struct SolenoidGroup::Module {
+    // Held across the HAL write so writes from different threads reach the
+    // PCM in the order their states were computed
+    wpi::mutex mutex;
+
+    // Written with the mutex held and read without it
+    std::atomic<uint32_t> commanded{0};
+};
+
+// PCM CAN IDs range from 0 to 62
+static constexpr int kMaxModules = 63;
+
+SolenoidGroup::SolenoidGroup(std::initializer_list<int> channels)
+    : SolenoidGroup(frc::SensorUtil::GetDefaultSolenoidModule(), channels) {}
+
+SolenoidGroup::SolenoidGroup(int module, std::initializer_list<int> channels)
+    : m_module{module} {
+    // Groups are constructed from many subsystems, so the modules' states
+    // live in a function-local static rather than in any one of them
+    static std::array<Module, kMaxModules> modules;
+    if (frc::SensorUtil::CheckSolenoidModule(module)) {
+        m_moduleState = &modules[module];
+    }
+
+    m_solenoids.reserve(channels.size());
+    for (int channel : channels) {
+        // frc::Solenoid reports invalid channels, so they're only left out of
+        // the mask here
+        m_solenoids.emplace_back(module, channel);
+        if (frc::SensorUtil::CheckSolenoidChannel(channel)) {
+            m_mask |= 1u << channel;
+        }
+    }
+}
+
+void SolenoidGroup::Set(bool on) { Write(m_mask, on); }
+
+void SolenoidGroup::Set(size_t index, bool on) {
+    int channel = m_solenoids[index].GetChannel();
+    if (frc::SensorUtil::CheckSolenoidChannel(channel)) {
+        Write(1u << channel, on);
+    }
+}
+
+bool SolenoidGroup::Get() const {
+    if (!m_moduleState) {
+        return false;
+    }
+
+    return (m_moduleState->commanded.load(std::memory_order_relaxed) &
+            m_mask) == m_mask;
+}
+
+bool SolenoidGroup::Get(size_t index) const {
+    int channel = m_solenoids[index].GetChannel();
+    if (!m_moduleState || !frc::SensorUtil::CheckSolenoidChannel(channel)) {
+        return false;
+    }
+
+    return (m_moduleState->commanded.load(std::memory_order_relaxed) &
+            (1u << channel)) != 0;
+}
+
+bool SolenoidGroup::GetReported(size_t index) const {
+    int channel = m_solenoids[index].GetChannel();
+    if (!frc::SensorUtil::CheckSolenoidChannel(channel)) {
+        return false;
+    }
+
+    int32_t status = 0;
+    uint32_t states = HAL_GetAllSolenoids(m_module, &status);
+    return status == 0 && (states & (1u << channel)) != 0;
+}
+
+bool SolenoidGroup::HasFault(size_t index) const {
+    int channel = m_solenoids[index].GetChannel();
+    if (!frc::SensorUtil::CheckSolenoidChannel(channel)) {
+        return true;
+    }
+
+    int32_t status = 0;
+    uint32_t blackList = HAL_GetPCMSolenoidBlackList(m_module, &status);
+    bool voltageFault = HAL_GetPCMSolenoidVoltageFault(m_module, &status);
+    return status != 0 || (blackList & (1u << channel)) != 0 || voltageFault;
+}
+
+int SolenoidGroup::GetChannel(size_t index) const {
+    return m_solenoids[index].GetChannel();
+}
+
+size_t SolenoidGroup::Size() const { return m_solenoids.size(); }
+
+units::second_t SolenoidGroup::GetLastHALCallDuration() const {
+    return units::nanosecond_t{
+        m_lastHALCallDuration.load(std::memory_order_relaxed)};
+}
+
+units::second_t SolenoidGroup::GetMaxHALCallDuration() const {
+    return units::nanosecond_t{
+        m_maxHALCallDuration.load(std::memory_order_relaxed)};
+}
+
+void SolenoidGroup::InitSendable(frc::SendableBuilder& builder) {
+    builder.AddDoubleProperty(
+        "writes",
+        [this] { return m_writes.load(std::memory_order_relaxed); }, nullptr);
+    builder.AddDoubleProperty(
+        "last HAL call duration (s)",
+        [this] { return GetLastHALCallDuration().to<double>(); }, nullptr);
+    builder.AddDoubleProperty(
+        "max HAL call duration (s)",
+        [this] { return GetMaxHALCallDuration().to<double>(); }, nullptr);
+}
+
+void SolenoidGroup::Write(uint32_t mask, bool on) {
+    if (!m_moduleState) {
+        return;
+    }
+
+    // Callers like the claw's zero switch check set the same state every
+    // iteration, so those calls return here without taking the lock or
+    // blocking on the CAN write
+    uint32_t commanded =
+        m_moduleState->commanded.load(std::memory_order_relaxed);
+    if ((on ? commanded | mask : commanded & ~mask) == commanded) {
+        return;
+    }
+
+    int32_t status = 0;
+    {
+        std::scoped_lock lock{m_moduleState->mutex};
+
+        uint32_t states =
+            m_moduleState->commanded.load(std::memory_order_relaxed);
+        states = on ? states | mask : states & ~mask;
+
+        auto startTime = std::chrono::steady_clock::now();
+        HAL_SetAllSolenoids(m_module, states, &status);
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - startTime)
+                            .count();
+
+        if (status == 0) {
+            m_moduleState->commanded.store(states, std::memory_order_relaxed);
+        }
+
+        m_lastHALCallDuration.store(duration, std::memory_order_relaxed);
+        int64_t maxDuration =
+            m_maxHALCallDuration.load(std::memory_order_relaxed);
+        while (duration > maxDuration &&
+               !m_maxHALCallDuration.compare_exchange_weak(
+                   maxDuration, duration, std::memory_order_relaxed)) {
+        }
+        m_writes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (status != 0) {
+        frc::DriverStation::ReportError(
+            "SolenoidGroup: PCM " + std::to_string(m_module) + ": " +
+            HAL_GetErrorMessage(status));
+    }
+}
+
+}  // namespace frc3512
@@ -0,0 +1,151 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "StartupProfiler.hpp"
+
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include <wpi/raw_ostream.h>
+
+namespace frc3512 {
+
+namespace {
+
+struct Record {
+    std::string_view name;
+    std::chrono::steady_clock::duration duration;
+};
+
+struct Phases {
+    std::array<Record, StartupProfiler::kMaxPhases> records;
+    size_t size = 0;
+    size_t dropped = 0;
+    std::optional<std::chrono::steady_clock::time_point> lastMark;
+};
+
+}  // namespace
+
+/**
+ * Returns the time since the process was created, if the platform reports it.
+ */
+static std::optional<std::chrono::steady_clock::duration> GetProcessAge() {
+#ifdef __linux__
+    // Field 22 of /proc/self/stat is the start time in clock ticks since boot.
+    // The executable name in field 2 may contain spaces, so parsing starts
+    // after its closing parenthesis.
+    std::ifstream file{"/proc/self/stat"};
+    std::string stat{std::istreambuf_iterator<char>{file},
+                     std::istreambuf_iterator<char>{}};
+    auto pos = stat.rfind(')');
+    if (pos == std::string::npos) {
+        return std::nullopt;
+    }
+
+    std::istringstream fields{stat.substr(pos + 2)};
+    std::string field;
+    for (int i = 3; i < 22; ++i) {
+        fields >> field;
+    }
+    unsigned long long startTicks;
+    if (!(fields >> startTicks)) {
+        return std::nullopt;
+    }
+
+    timespec now;
+    if (clock_gettime(CLOCK_BOOTTIME, &now) != 0) {
+        return std::nullopt;
+    }
+
+    std::chrono::duration<double> age =
+        std::chrono::seconds{now.tv_sec} +
+        std::chrono::nanoseconds{now.tv_nsec} -
+        std::chrono::duration<double>{static_cast<double>(startTicks) /
+                                      sysconf(_SC_CLK_TCK)};
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        age);
+#else
+    return std::nullopt;
+#endif
+}
+
+/**
+ * Returns the recorded phases.
+ *
+ * A function-local static is used so marks made during static initialization
+ * of other translation units are safe.
+ */
+static Phases& GetPhases() {
+    static Phases phases;
+    return phases;
+}
+
+void StartupProfiler::Mark(std::string_view name) {
+    auto now = std::chrono::steady_clock::now();
+    auto& phases = GetPhases();
+
+    std::chrono::steady_clock::duration duration{0};
+    if (phases.lastMark) {
+        duration = now - *phases.lastMark;
+    } else if (auto age = GetProcessAge()) {
+        duration = *age;
+    }
+
+    // Restart the clock after computing the duration so reading the process
+    // age isn't counted toward the next phase
+    phases.lastMark = std::chrono::steady_clock::now();
+
+    if (phases.size == kMaxPhases) {
+        ++phases.dropped;
+        return;
+    }
+    phases.records[phases.size++] = Record{name, duration};
+}
+
+void StartupProfiler::Reset() {
+    auto& phases = GetPhases();
+    phases.size = 0;
+    phases.dropped = 0;
+    phases.lastMark = std::chrono::steady_clock::now();
+}
+
+void StartupProfiler::Print() {
+    const auto& phases = GetPhases();
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-40s %12s\n", "startup phase",
+                  "duration (ms)");
+    wpi::outs() << line;
+
+    std::chrono::duration<double, std::milli> total{0};
+    for (size_t i = 0; i < phases.size; ++i) {
+        const auto& record = phases.records[i];
+        std::chrono::duration<double, std::milli> duration = record.duration;
+        total += duration;
+
+        std::string name{record.name};
+        std::snprintf(line, sizeof(line), "%-40s %12.3f\n", name.c_str(),
+                      duration.count());
+        wpi::outs() << line;
+    }
+
+    std::snprintf(line, sizeof(line), "%-40s %12.3f\n", "total",
+                  total.count());
+    wpi::outs() << line;
+
+    if (phases.dropped > 0) {
+        wpi::outs() << phases.dropped << " startup phases weren't recorded\n";
+    }
+}
+
+}  // namespace frc3512
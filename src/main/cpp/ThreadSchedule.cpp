@@ -0,0 +1,111 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "ThreadSchedule.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <cstring>
+
+#include <frc/DriverStation.h>
+#include <frc/Threads.h>
+#include <wpi/raw_ostream.h>
+
+namespace frc3512 {
+
+#ifdef __linux__
+using NativeHandle = pthread_t;
+#else
+using NativeHandle = void*;
+#endif
+
+/**
+ * Pins a thread to a core.
+ *
+ * @return An empty string on success or the reason for failure.
+ */
+static std::string SetAffinity(NativeHandle thread, int core) {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    int error = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+    if (error != 0) {
+        return std::strerror(error);
+    }
+    return "";
+#else
+    return "CPU affinity isn't supported on this platform";
+#endif
+}
+
+/**
+ * Applies the priority with setPriority and the affinity to the given thread,
+ * then reports the result.
+ */
+template <typename SetPriority>
+static bool Apply(NativeHandle thread, const std::string& name,
+                  const ThreadSchedule& schedule, SetPriority setPriority) {
+    bool success = true;
+
+    if (schedule.priority > 0 && !setPriority(schedule.priority)) {
+        frc::DriverStation::ReportError("Thread '" + name +
+                                        "': failed to set SCHED_FIFO "
+                                        "priority " +
+                                        std::to_string(schedule.priority));
+        success = false;
+    }
+
+    if (schedule.core >= 0) {
+        if (auto error = SetAffinity(thread, schedule.core); !error.empty()) {
+            frc::DriverStation::ReportError(
+                "Thread '" + name + "': failed to pin to core " +
+                std::to_string(schedule.core) + ": " + error);
+            success = false;
+        }
+    }
+
+    if (success) {
+        wpi::outs() << "Thread '" << name << "': ";
+        if (schedule.priority > 0) {
+            wpi::outs() << "SCHED_FIFO priority " << schedule.priority;
+        } else {
+            wpi::outs() << "default priority";
+        }
+        if (schedule.core >= 0) {
+            wpi::outs() << ", core " << schedule.core << '\n';
+        } else {
+            wpi::outs() << ", any core\n";
+        }
+    }
+
+    return success;
+}
+
+bool ApplyThreadSchedule(const std::string& name,
+                         const ThreadSchedule& schedule) {
+#ifdef __linux__
+    NativeHandle thread = pthread_self();
+#else
+    NativeHandle thread = nullptr;
+#endif
+    return Apply(thread, name, schedule, [](int priority) {
+        return frc::SetCurrentThreadPriority(true, priority);
+    });
+}
+
+bool ApplyThreadSchedule(std::thread& thread, const std::string& name,
+                         const ThreadSchedule& schedule) {
+#ifdef __linux__
+    NativeHandle handle = thread.native_handle();
+#else
+    NativeHandle handle = nullptr;
+#endif
+    return Apply(handle, name, schedule, [&](int priority) {
+        return frc::SetThreadPriority(thread, true, priority);
+    });
+}
+
+}  // namespace frc3512
@@ -12,18 +12,12 @@ void Robot::AutonDriveForward() {
     while (!timer.HasPeriodPassed(0.5_s)) {
         m_drivetrain.Drive(-0.1, 0, false);
         m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
-        }
     }
 
     // Drive 2
     while (!timer.HasPeriodPassed(0.5_s)) {
         m_drivetrain.Drive(-0.5, 0, false);
         m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
-        }
     }
     m_drivetrain.Drive(0, 0, false);
 }
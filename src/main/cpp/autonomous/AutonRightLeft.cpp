@@ -14,81 +14,67 @@ void Robot::AutonRightLeft() {
 
     m_drivetrain.ResetEncoders();
 
-    // Wait
-    while (!timer.HasPeriodPassed(0.5_s)) {
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
-        }
+    {
+        auto phase = m_autonChooser.Phase("wait");
+        m_autonChooser.Wait(0.5_s);
     }
 
-    while (!timer.HasPeriodPassed(0.25_s)) {
-        m_drivetrain.Drive(-0.1, 0, false);
-
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
+    {
+        auto phase = m_autonChooser.Phase("creep forward");
+        timer.Reset();
+        while (!timer.HasPeriodPassed(0.25_s)) {
+            m_drivetrain.Drive(-0.1, 0, false);
+            m_autonChooser.YieldToMain();
         }
     }
 
-    m_claw.SetAngleReference(115_deg);
-
-    while (!timer.HasPeriodPassed(0.5_s)) {
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
-        }
+    {
+        auto phase = m_autonChooser.Phase("raise claw");
+        m_claw.SetAngleReference(115_deg);
+        m_autonChooser.Wait(0.5_s);
     }
 
-    while (m_drivetrain.GetRightDist() < kTargetDistance &&
-           m_drivetrain.GetRightDist() > -5_in) {
-        double targetValue =
-            -0.6 * (1.0 - m_drivetrain.GetRightDist() / kTargetDistance);
-        m_drivetrain.Drive(targetValue, 0, false);
-
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
-        }
+    {
+        auto phase = m_autonChooser.Phase("drive to goal");
+        m_drivetrain.SetLeftGoal(kTargetDistance);
+        m_drivetrain.SetRightGoal(kTargetDistance);
+        m_drivetrain.EnableController();
+        // If a side stalls short of its goal, shoot from where it stopped
+        // rather than waiting out the rest of autonomous
+        m_autonChooser.Until(
+            [this] { return m_drivetrain.AtGoal(); },
+            Drivetrain::GetProfileTime(kTargetDistance) + 1_s);
+        m_drivetrain.DisableController();
     }
 
-    // Rotate robot to straighten it out
-    while (-m_drivetrain.GetLeftDist() < m_drivetrain.GetRightDist()) {
-        m_drivetrain.Drive(0.0, 0.3, true);
-
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
+    {
+        // Rotate robot to straighten it out
+        auto phase = m_autonChooser.Phase("straighten");
+        while (-m_drivetrain.GetLeftDist() < m_drivetrain.GetRightDist()) {
+            m_drivetrain.Drive(0.0, 0.3, true);
+            m_autonChooser.YieldToMain();
         }
     }
 
     m_claw.SetWheel(0.0);
 
-    timer.Reset();
-    while (!timer.HasPeriodPassed(0.1_s)) {
-        m_drivetrain.Drive(-0.1, 0.0, false);
-
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
+    {
+        auto phase = m_autonChooser.Phase("settle");
+        timer.Reset();
+        while (!timer.HasPeriodPassed(0.1_s)) {
+            m_drivetrain.Drive(-0.1, 0.0, false);
+            m_autonChooser.YieldToMain();
         }
     }
 
     if (!targetLit) {
-        while (!timer.HasPeriodPassed(0.5_s)) {
-            m_autonChooser.YieldToMain();
-            if (!IsAutonomousEnabled()) {
-                return;
-            }
-        }
+        auto phase = m_autonChooser.Phase("wait for hot goal");
+        m_autonChooser.Wait(0.5_s);
     }
 
-    m_claw.Shoot();
-
-    while (m_claw.IsShooting()) {
-        m_autonChooser.YieldToMain();
-        if (!IsAutonomousEnabled()) {
-            return;
-        }
+    {
+        auto phase = m_autonChooser.Phase("shoot");
+        m_claw.Shoot();
+        m_autonChooser.Until([this] { return !m_claw.IsShooting(); });
     }
 }
@@ -2,44 +2,109 @@
 
 #include "subsystems/Claw.hpp"
 
-#include <frc/DriverStation.h>
-#include <frc/Joystick.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include <frc/RobotBase.h>
+#include <frc/RobotController.h>
+#include <frc/StateSpaceUtil.h>
+#include <frc/smartdashboard/SmartDashboard.h>
 #include <wpi/math>
+#include <wpi/raw_ostream.h>
+
+#include "InterpolatingTable.hpp"
+
+static constexpr size_t kFeedforwardSamples = static_cast<size_t>(
+    Claw::kMaxFeedforwardAngle - Claw::kMinFeedforwardAngle + 1.0);
+
+static constexpr frc3512::InterpolatingTable<kFeedforwardSamples>
+    kFeedforwardCosTable{
+        Claw::kMinFeedforwardAngle, Claw::kMaxFeedforwardAngle,
+        [](double angle) {
+            return frc3512::ConstexprCos((angle + Claw::kL) * wpi::math::pi /
+                                         180.0);
+        }};
+
+// The vacuum comes after the shooter solenoids in the self-test results
+static constexpr size_t kVacuumTestActuator = Claw::kTestActuators - 1;
+
+/**
+ * One step of the self-test: an actuator and the state to hold it in for
+ * Claw::kTestStepDuration.
+ */
+struct TestStep {
+    size_t actuator;
+    bool on;
+};
+
+// Each shooter solenoid is switched on and off, followed each time by the
+// vacuum
+static constexpr auto kTestSequence = [] {
+    std::array<TestStep, 4 * kVacuumTestActuator> steps{};
+    size_t i = 0;
+    for (size_t solenoid = 0; solenoid < kVacuumTestActuator; ++solenoid) {
+        steps[i++] = {solenoid, true};
+        steps[i++] = {solenoid, false};
+        steps[i++] = {kVacuumTestActuator, true};
+        steps[i++] = {kVacuumTestActuator, false};
+    }
+    return steps;
+}();
 
-Claw::Claw() {
+Claw::Claw(const frc3512::ThreadSchedule& schedule) : m_schedule{schedule} {
     // Sets degrees rotated per pulse of encoder
     m_angleEncoder.SetDistancePerPulse((1.0 / 71.0) * 14.0 / 44.0);
 
-    m_ballShooter.emplace_back(8);
-    m_ballShooter.emplace_back(2);
-    m_ballShooter.emplace_back(3);
-    m_ballShooter.emplace_back(6);
+    frc::SmartDashboard::PutData("Ball shooter", &m_ballShooter);
+
+    SetSimulatedAngle(0_deg);
+
+    m_controllerThread.StartPeriodic(kDt);
 }
 
 void Claw::SetAngleReference(units::degree_t shooterAngle) {
-    m_controller.SetSetpoint(shooterAngle.to<double>());
+    // There's only one writer, so a load and store is enough to bump the
+    // generation, and neither can ever wait
+    m_referenceRequest.store(shooterAngle.to<double>(),
+                             std::memory_order_relaxed);
+    m_referenceGeneration.store(
+        m_referenceGeneration.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
 }
 
 units::degree_t Claw::GetAngleReference() const {
-    return units::degree_t{m_controller.GetSetpoint()};
+    // Report a reference the controller hasn't adopted yet so callers see
+    // their own writes
+    auto state = m_state.Load();
+    if (m_referenceGeneration.load(std::memory_order_acquire) !=
+        state.referenceGeneration) {
+        return units::degree_t{
+            m_referenceRequest.load(std::memory_order_relaxed)};
+    }
+    return units::degree_t{state.reference};
 }
 
-void Claw::SetWheel(double speed) { m_intakeWheel.Set(speed); }
+void Claw::SetWheel(double speed) {
+    m_wheelSpeed.store(speed, std::memory_order_relaxed);
+}
 
 void Claw::Shoot() {
-    if (m_shooterState == ShooterState::kIdle) {
-        m_collectorArm.Set(true);
-        m_shooterState = ShooterState::kArmIsLifting;
-        m_shootTimer.Start();
-        m_shootTimer.Reset();
+    if (!IsShooting()) {
+        m_shootRequested = true;
+        m_shooterThread.StartSingle(0_s);
     }
 }
 
-bool Claw::IsShooting() const { return m_shooterState != ShooterState::kIdle; }
+bool Claw::IsShooting() const {
+    // The request is cleared only after the sequencer leaves the idle state,
+    // so checking it first never misses a shot in progress
+    return m_shootRequested || m_shooterState != ShooterState::kIdle;
+}
 
-void Claw::RobotPeriodic() {
-    static frc::Joystick driveStick2{2};
-    static frc::Joystick shootStick{3};
+void Claw::RobotPeriodic(const frc3512::OperatorInput& input) {
+    const auto& driveStick2 = input.GetJoystick(2);
+    const auto& shootStick = input.GetJoystick(3);
 
     if (driveStick2.GetRawButtonPressed(7)) {
         SetAngleReference(190_deg);
@@ -55,7 +120,7 @@ void Claw::RobotPeriodic() {
 
     if (driveStick2.GetRawButtonPressed(11)) {
         // Collector should always be retracted when resetting encoder
-        m_collectorArm.Set(false);
+        m_collectorRequest = CollectorRequest::kRetract;
         SetAngleReference(0_deg);
     }
 
@@ -69,7 +134,7 @@ void Claw::RobotPeriodic() {
 
     // Engage collector
     if (driveStick2.GetRawButtonPressed(2)) {
-        m_collectorArm.Set(!m_collectorArm.Get());
+        m_collectorRequest = CollectorRequest::kToggle;
     }
 
     // Shoots a ball
@@ -86,90 +151,355 @@ void Claw::RobotPeriodic() {
     } else {
         SetWheel(0.0);
     }
+}
+
+double Claw::FeedforwardCos(double angle) {
+    return kFeedforwardCosTable(angle);
+}
+
+void Claw::PublishLoopTiming() { m_controllerTimer.Publish(); }
+
+void Claw::RunController() {
+    // Notifier creates its thread internally, so it can only be scheduled
+    // from the callback
+    if (!m_scheduleApplied) {
+        frc3512::ApplyThreadSchedule("Claw controller", m_schedule);
+        m_scheduleApplied = true;
+    }
 
-    double ff = 0.0;
-    if (m_controller.GetSetpoint() > 0.0) {
-        ff = kK *
-             std::cos((m_angleEncoder.GetDistance() + kL) * wpi::math::pi /
-                      180.0) /
-             m_controller.GetSetpoint();
+    auto timing = m_controllerTimer.Time();
+    if (frc::RobotBase::IsSimulation()) {
+        UpdateSimulation();
     }
-    double fb = m_controller.Calculate(m_angleEncoder.GetDistance());
+    ControllerPeriodic();
+}
+
+void Claw::UpdateSimulation() {
+    units::degree_t lastAngle = m_armSim.GetAngle();
+
+    m_armSim.SetInputVoltage(units::volt_t{
+        m_clawRotatorSim.GetSpeed() * frc::RobotController::GetInputVoltage()});
+    m_armSim.Update(kDt);
 
-    m_clawRotator.Set(ff + fb);
+    // The encoder is advanced by how far the arm moved rather than set to the
+    // arm's angle, so encoder resets and drift behave like they do on the
+    // robot
+    units::degree_t angle = m_armSim.GetAngle();
+    m_angleEncoderSim.SetDistance(m_angleEncoderSim.GetDistance() +
+                                  (angle - lastAngle).to<double>());
+    m_angleEncoderSim.SetRate(
+        units::degrees_per_second_t{m_armSim.GetVelocity()}.to<double>());
 
-    if (m_shooterState == ShooterState::kArmIsLifting &&
-        m_shootTimer.HasPeriodPassed(0.5_s)) {
-        for (auto& solenoid : m_ballShooter) {
-            solenoid.Set(true);
+    // The zero switch reads false while pressed
+    m_zeroSwitchSim.SetValue(!m_armSim.HasHitLowerLimit());
+}
+
+void Claw::ApplyTestStep(size_t actuator, bool on) {
+    if (actuator == kVacuumTestActuator) {
+        m_vacuum.Set(on ? frc::Relay::kOn : frc::Relay::kOff);
+    } else {
+        m_ballShooter.Set(actuator, on);
+    }
+}
+
+void Claw::CheckTestStep(size_t actuator, bool on) {
+    // Relay::Get() only returns the commanded state and nothing senses the
+    // vacuum, so it's still switched for the pit crew to watch but not graded
+    if (actuator == kVacuumTestActuator) {
+        m_testResults[actuator].sensed = false;
+        m_testResults[actuator].passed = false;
+        return;
+    }
+
+    if (m_ballShooter.GetReported(actuator) != on ||
+        m_ballShooter.HasFault(actuator)) {
+        m_testResults[actuator].passed = false;
+    }
+}
+
+void Claw::PrintTestResults() const {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-20s %8s %12s\n", "actuator",
+                  "result", "on time (s)");
+    wpi::outs() << line;
+
+    for (size_t i = 0; i < kTestActuators; ++i) {
+        std::string name = "vacuum";
+        if (i != kVacuumTestActuator) {
+            name = "shooter solenoid " +
+                   std::to_string(m_ballShooter.GetChannel(i));
+        }
+
+        const auto& result = m_testResults[i];
+        const char* verdict = "untested";
+        if (result.tested && !result.sensed) {
+            verdict = "unsensed";
+        } else if (result.tested) {
+            verdict = result.passed ? "pass" : "FAIL";
         }
-        m_shootTimer.Reset();
-        m_shooterState = ShooterState::kShooting;
+
+        std::snprintf(line, sizeof(line), "%-20s %8s %12.3f\n", name.c_str(),
+                      verdict, result.onTime.to<double>());
+        wpi::outs() << line;
     }
-    if (m_shooterState == ShooterState::kShooting &&
-        m_shootTimer.HasPeriodPassed(2.0_s)) {
-        for (auto& solenoid : m_ballShooter) {
-            solenoid.Set(false);
+}
+
+Claw::AngleController::AngleController(const Gains& gains)
+    : m_kK{gains.kK}, m_controller{gains.kP, gains.kI, gains.kD, kDt} {
+    for (double from : kPresets) {
+        for (double to : kPresets) {
+            m_presetProfiles.emplace_back(
+                AngleProfile::Constraints{kMaxVelocity, kMaxAcceleration},
+                AngleProfile::State{units::degree_t{to}, 0_deg_per_s},
+                AngleProfile::State{units::degree_t{from}, 0_deg_per_s});
         }
-        m_vacuum.Set(frc::Relay::kOn);
-        m_shootTimer.Reset();
-        m_shooterState = ShooterState::kVacuuming;
     }
-    if (m_shooterState == ShooterState::kVacuuming &&
-        m_shootTimer.HasPeriodPassed(3.0_s)) {
-        m_vacuum.Set(frc::Relay::kOff);
-        m_collectorArm.Set(false);
+}
 
-        m_shootTimer.Reset();
-        m_shooterState = ShooterState::kIdle;
+void Claw::AngleController::SetGoal(double goal, units::second_t now,
+                                    units::degrees_per_second_t maxVelocity) {
+    auto elapsed = now - m_profileStartTime;
+
+    auto from = std::find(kPresets.begin(), kPresets.end(), m_goal);
+    auto to = std::find(kPresets.begin(), kPresets.end(), goal);
+    if (m_profile.IsFinished(elapsed) && from != kPresets.end() &&
+        to != kPresets.end()) {
+        // At rest on a preset and moving to another, so the profile was
+        // already generated
+        m_profile = m_presetProfiles[(from - kPresets.begin()) *
+                                         kPresets.size() +
+                                     (to - kPresets.begin())];
+    } else {
+        m_profile = AngleProfile{
+            {maxVelocity, kMaxAcceleration},
+            {units::degree_t{goal}, 0_deg_per_s},
+            m_profile.Calculate(elapsed)};
     }
+    m_profileStartTime = now;
+    m_goal = goal;
 
-    // Spins intake wheel to keep ball in while rotating claw at high speeds
-    if (std::abs(m_angleEncoder.GetRate()) > 35.0) {
-        SetWheel(-1.0);
+    // The feedforward only holds the claw up at positive references
+    if (goal > 0.0) {
+        m_feedforwardScale = m_kK / goal;
+    } else {
+        m_feedforwardScale = 0.0;
     }
+}
+
+void Claw::AngleController::Reset(units::second_t now, double angle) {
+    AngleProfile::State rest{units::degree_t{angle}, 0_deg_per_s};
+    m_profile = AngleProfile{{kMaxVelocity, kMaxAcceleration}, rest, rest};
+    m_profileStartTime = now;
+    m_goal = angle;
+    m_feedforwardScale = angle > 0.0 ? m_kK / angle : 0.0;
+    m_controller.SetSetpoint(angle);
+    m_controller.Reset();
+}
+
+double Claw::AngleController::GetGoal() const { return m_goal; }
+
+Claw::AngleController::Output Claw::AngleController::Calculate(
+    double angle, bool zeroSwitch, units::second_t now) {
+    // Sampling the profile is a closed-form evaluation, so it costs the same
+    // every iteration
+    auto reference = m_profile.Calculate(now - m_profileStartTime);
+    m_controller.SetSetpoint(reference.position.to<double>());
+
+    double ff = m_feedforwardScale * FeedforwardCos(angle);
+    double fb = m_controller.Calculate(angle);
+    Output output{ff + fb, false};
 
     /* Fixes arm, when at reset angle, not touching zeroSwitch due to gradual
      * encoder error. If limit switch isn't pressed but arm is supposedly at
-     * zeroing point or farther:
+     * zeroing point or farther, drive it down past zero until the switch
+     * trips. The goal is set once, so the profile is only rebuilt when the
+     * re-homing move starts.
      */
-    if (m_zeroSwitch.Get() && GetAngleReference() <= 1_deg) {
-        SetAngleReference(GetAngleReference() - 5_deg);
+    if (zeroSwitch && m_goal <= 1.0 && m_goal != kRehomeGoal) {
+        SetGoal(kRehomeGoal, now, kRehomeVelocity);
     }
 
     // If wasn't pressed last time and is now
-    if (!m_zeroSwitch.Get() && GetAngleReference() <= 0_deg) {
-        SetAngleReference(0_deg);
-        m_controller.Reset();
+    if (!zeroSwitch && m_goal <= 0.0) {
+        Reset(now);
+        output.rehomed = true;
+    }
+
+    return output;
+}
+
+void Claw::ControllerPeriodic() {
+    auto now = frc2::Timer::GetFPGATimestamp();
+
+    uint32_t generation =
+        m_referenceGeneration.load(std::memory_order_acquire);
+    if (generation != m_adoptedGeneration) {
+        m_controller.SetGoal(
+            m_referenceRequest.load(std::memory_order_relaxed), now);
+        m_adoptedGeneration = generation;
+    }
+
+    double angle = m_angleEncoder.GetDistance();
+    m_angleVelocity.Add(now, angle);
+    auto output = m_controller.Calculate(angle, m_zeroSwitch.Get(), now);
+
+    m_clawRotator.Set(output.motor);
+
+    // Spins intake wheel to keep ball in while rotating claw at high speeds
+    if (std::abs(m_angleVelocity.LeastSquaresSlope()) > 35.0) {
+        m_intakeWheel.Set(-1.0);
+    } else {
+        m_intakeWheel.Set(m_wheelSpeed.load(std::memory_order_relaxed));
+    }
+
+    if (output.rehomed) {
         m_angleEncoder.Reset();
+        m_angleVelocity.Clear();
     }
 
-    // Close claw if zero switch is pressed
+    UpdateCollectorArm();
+
+    m_lastZeroSwitch = m_zeroSwitch.Get();
+
+    m_state.Store(
+        ControllerState{m_controller.GetGoal(), m_adoptedGeneration});
+}
+
+void Claw::UpdateCollectorArm() {
+    switch (m_collectorRequest.exchange(CollectorRequest::kNone)) {
+        case CollectorRequest::kRetract:
+            m_collectorArm.Set(false);
+            break;
+        case CollectorRequest::kToggle:
+            m_collectorArm.Set(!m_collectorArm.Get());
+            break;
+        case CollectorRequest::kNone:
+            break;
+    }
+
+    // Close claw if zero switch is pressed. Shoot() marks the claw as
+    // shooting before the sequencer starts, so this can't retract the arm
+    // once a shot has been requested.
     if (m_zeroSwitch.Get() && !IsShooting()) {
         m_collectorArm.Set(false);
     }
+}
+
+void Claw::RunShooterSequence() {
+    if (!m_shooterScheduleApplied) {
+        frc3512::ApplyThreadSchedule("Claw shooter", m_schedule);
+        m_shooterScheduleApplied = true;
+    }
 
-    m_lastZeroSwitch = m_zeroSwitch.Get();
+    // Deadlines are measured from the previous deadline rather than from
+    // when this callback ran, so wakeup latency doesn't accumulate
+    units::second_t now = frc2::Timer::GetFPGATimestamp();
+
+    if (m_shooterState == ShooterState::kIdle) {
+        if (!m_shootRequested) {
+            return;
+        }
+        m_shooterStep = 0;
+        m_shooterDeadline = now;
+    } else {
+        ++m_shooterStep;
+    }
+
+    const auto& step = m_shooterStep < kShooterSequence.size()
+                           ? kShooterSequence[m_shooterStep]
+                           : kShooterIdleStep;
+
+    // The arm is set here rather than on the controller thread so it moves
+    // with the rest of the step instead of up to a controller period later
+    m_collectorArm.Set(step.collectorArm);
+    m_ballShooter.Set(step.shooter);
+    m_vacuum.Set(step.vacuum ? frc::Relay::kOn : frc::Relay::kOff);
+
+    m_shooterState = step.state;
+    if (m_shooterStep == 0) {
+        // Cleared only when starting, so a Shoot() that lands while the last
+        // step is finishing isn't lost
+        m_shootRequested = false;
+    }
+
+    if (step.state != ShooterState::kIdle) {
+        m_shooterDeadline += step.duration;
+        m_shooterThread.StartSingle(
+            std::max(m_shooterDeadline - now, units::second_t{0}));
+    }
 }
 
-void Claw::TestClaw() {
-    auto& ds = frc::DriverStation::GetInstance();
+units::degree_t Claw::GetAngle() const {
+    return units::degree_t{m_angleEncoder.GetDistance()};
+}
 
-    for (auto& solenoid : m_ballShooter) {
-        solenoid.Set(true);
-        frc2::Wait(1.5_s);
+void Claw::SetSimulatedAngle(units::degree_t angle) {
+    units::radian_t armAngle = angle + units::degree_t{kL};
+    m_armSim.SetState(frc::MakeMatrix<2, 1>(armAngle.to<double>(), 0.0));
+    m_zeroSwitchSim.SetValue(angle > 0_deg);
+}
 
-        solenoid.Set(false);
-        frc2::Wait(1.5_s);
+void Claw::StartTest() {
+    StopTest();
 
-        m_vacuum.Set(frc::Relay::kOn);
-        frc2::Wait(1.5_s);
+    m_testResults = {};
+    m_isTesting = true;
+    m_testStep = 0;
 
-        m_vacuum.Set(frc::Relay::kOff);
-        frc2::Wait(1.5_s);
+    m_testStepStartTime = frc2::Timer::GetFPGATimestamp();
+    m_testStepDeadline = m_testStepStartTime + kTestStepDuration;
+    ApplyTestStep(kTestSequence[0].actuator, kTestSequence[0].on);
+}
 
-        if (ds.IsDisabled()) {
-            return;
-        }
+void Claw::TestPeriodic() {
+    if (!m_isTesting) {
+        return;
+    }
+
+    auto now = frc2::Timer::GetFPGATimestamp();
+    if (now < m_testStepDeadline) {
+        return;
     }
+
+    // The PCM's status frame lags the command, so the state is only checked
+    // once the step has been held for its full duration
+    const auto& step = kTestSequence[m_testStep];
+    CheckTestStep(step.actuator, step.on);
+    if (step.on) {
+        m_testResults[step.actuator].onTime = now - m_testStepStartTime;
+    } else {
+        m_testResults[step.actuator].tested = true;
+    }
+
+    ++m_testStep;
+    if (m_testStep == kTestSequence.size()) {
+        m_isTesting = false;
+        PrintTestResults();
+        return;
+    }
+
+    // Each step is held for its full duration from when it's applied, so a
+    // late cycle doesn't shorten the next step
+    m_testStepStartTime = now;
+    m_testStepDeadline = now + kTestStepDuration;
+    ApplyTestStep(kTestSequence[m_testStep].actuator,
+                  kTestSequence[m_testStep].on);
+}
+
+void Claw::StopTest() {
+    if (!m_isTesting) {
+        return;
+    }
+
+    m_isTesting = false;
+    if (const auto& step = kTestSequence[m_testStep]; step.on) {
+        ApplyTestStep(step.actuator, false);
+    }
+}
+
+bool Claw::IsTestFinished() const { return !m_isTesting; }
+
+const std::array<Claw::ActuatorTestResult, Claw::kTestActuators>&
+Claw::GetTestResults() const {
+    return m_testResults;
 }
@@ -2,7 +2,6 @@
 
 #include "subsystems/Drivetrain.hpp"
 
-#include <frc/Joystick.h>
 #include <wpi/math>
 
 Drivetrain::Drivetrain() {
@@ -10,6 +9,9 @@ Drivetrain::Drivetrain() {
     constexpr double kDpP = wpi::math::pi * kWheelDiameter.to<double>() / 360.0;
     m_leftEncoder.SetDistancePerPulse(kDpP);
     m_rightEncoder.SetDistancePerPulse(kDpP);
+
+    m_leftController.SetTolerance(kPositionTolerance, kVelocityTolerance);
+    m_rightController.SetTolerance(kPositionTolerance, kVelocityTolerance);
 }
 
 void Drivetrain::Drive(double xSpeed, double zRotation, bool isQuickTurn) {
@@ -29,6 +31,48 @@ void Drivetrain::SetRightGoal(units::meter_t goal) {
     m_rightController.SetGoal(goal);
 }
 
+void Drivetrain::EnableController() {
+    // Driving forward is negative distance on the left side
+    m_leftController.Reset(-GetLeftDist());
+    m_rightController.Reset(GetRightDist());
+    m_lastLeftVelocity = 0_mps;
+    m_lastRightVelocity = 0_mps;
+    m_isControllerEnabled = true;
+}
+
+void Drivetrain::DisableController() {
+    if (m_isControllerEnabled) {
+        m_isControllerEnabled = false;
+        m_robotDrive.StopMotor();
+    }
+}
+
+bool Drivetrain::IsControllerEnabled() const { return m_isControllerEnabled; }
+
+bool Drivetrain::AtGoal() const {
+    return m_leftController.AtGoal() && m_rightController.AtGoal();
+}
+
+void Drivetrain::ControllerPeriodic() {
+    if (!m_isControllerEnabled) {
+        return;
+    }
+
+    // Driving forward is negative output and distance on the left side and
+    // positive on the right. DifferentialDrive inverts the right side, but
+    // it's bypassed here.
+    auto left =
+        CalculateSide(m_leftController, -GetLeftDist(), m_lastLeftVelocity);
+    auto right =
+        CalculateSide(m_rightController, GetRightDist(), m_lastRightVelocity);
+    m_leftGrbx.SetVoltage(-left);
+    m_rightGrbx.SetVoltage(right);
+
+    // Keeps DifferentialDrive's motor safety from stopping the motors while
+    // it isn't being used
+    m_robotDrive.Feed();
+}
+
 units::inch_t Drivetrain::GetLeftDist() const {
     return units::inch_t{m_leftEncoder.GetDistance()};
 }
@@ -37,9 +81,19 @@ units::inch_t Drivetrain::GetRightDist() const {
     return units::inch_t{m_rightEncoder.GetDistance()};
 }
 
-void Drivetrain::TeleopPeriodic() {
-    static frc::Joystick driveStick1{1};
-    static frc::Joystick driveStick2{2};
+double Drivetrain::GetLeftOutput() const { return m_leftGrbx.Get(); }
+
+double Drivetrain::GetRightOutput() const { return m_rightGrbx.Get(); }
+
+void Drivetrain::SetSimulatedDistances(units::inch_t left,
+                                       units::inch_t right) {
+    m_leftEncoderSim.SetDistance(left.to<double>());
+    m_rightEncoderSim.SetDistance(right.to<double>());
+}
+
+void Drivetrain::TeleopPeriodic(const frc3512::OperatorInput& input) {
+    const auto& driveStick1 = input.GetJoystick(1);
+    const auto& driveStick2 = input.GetJoystick(2);
 
     if (driveStick1.GetRawButtonPressed(1)) {
         m_shifter.Set(!m_shifter.Get());
@@ -57,3 +111,43 @@ void Drivetrain::TeleopPeriodic() {
               driveStick2.GetRawButtonPressed(2));
     }
 }
+
+void Drivetrain::SimulationPeriodic(units::second_t dt) {
+    units::inch_t leftDist =
+        GetLeftDist() + m_leftGrbx.Get() * kMaxSpeed * dt;
+    units::inch_t rightDist =
+        GetRightDist() + m_rightGrbx.Get() * kMaxSpeed * dt;
+    SetSimulatedDistances(leftDist, rightDist);
+}
+
+units::volt_t Drivetrain::CalculateSide(
+    frc::ProfiledPIDController<units::meter>& controller,
+    units::meter_t position, units::meters_per_second_t& lastVelocity) {
+    units::volt_t feedback{controller.Calculate(position)};
+
+    auto setpoint = controller.GetSetpoint();
+    auto feedforward = m_feedforward.Calculate(
+        setpoint.velocity, (setpoint.velocity - lastVelocity) / kDt);
+    lastVelocity = setpoint.velocity;
+
+    // Once the profile stops, the feedforward no longer overcomes static
+    // friction, and proportional feedback alone doesn't either until the
+    // error is kS / kP (about 5 in). Adding kS in the direction of the error
+    // while outside tolerance lets the side settle within it.
+    if (setpoint.velocity == 0_mps) {
+        auto error = setpoint.position - position;
+        if (error > kPositionTolerance) {
+            feedback += kS;
+        } else if (error < -kPositionTolerance) {
+            feedback -= kS;
+        }
+    }
+
+    return feedforward + feedback;
+}
+
+units::second_t Drivetrain::GetProfileTime(units::meter_t distance) {
+    frc::TrapezoidProfile<units::meter> profile{
+        {kMaxVelocity, kMaxAcceleration}, {distance, 0_mps}};
+    return profile.TotalTime();
+}
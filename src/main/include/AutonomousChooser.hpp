@@ -3,19 +3,29 @@
 #pragma once
 
 #include <atomic>
-#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 #include <frc/smartdashboard/Sendable.h>
 #include <frc/smartdashboard/SendableBuilder.h>
+#include <frc2/Timer.h>
 #include <networktables/NetworkTableEntry.h>
-#include <wpi/StringMap.h>
+#include <units/time.h>
+#include <wpi/ArrayRef.h>
 #include <wpi/StringRef.h>
 #include <wpi/condition_variable.h>
 #include <wpi/mutex.h>
 
+#include "AutonomousMode.hpp"
+#include "Fiber.hpp"
+#include "PhaseProfiler.hpp"
+#include "ThreadSchedule.hpp"
+
 namespace frc3512 {
 
 /**
@@ -25,25 +35,55 @@ namespace frc3512 {
 class AutonomousChooser : public frc::Sendable {
 public:
     /**
-     * Constructs an AutonomousChooser.
-     *
-     * Adds an autonomous mode that's run by default if no other autonomous mode
-     * is selected.
-     *
-     * @param name Name of autonomous mode.
-     * @param func Autonomous mode function.
+     * Determines how the autonomous mode function is run.
      */
-    AutonomousChooser(wpi::StringRef name, std::function<void()> func);
+    enum class Backend {
+        /// Run on a separate thread. The thread is created at construction and
+        /// parked between autonomous modes. Control is handed between it and
+        /// the main robot thread with a condition variable.
+        kThread,
 
-    ~AutonomousChooser();
+        /// Run as a fiber on the main robot thread. Control is handed off with
+        /// a user-space stack switch.
+        kFiber
+    };
+
+    /**
+     * Scheduling settings for the threads AutonomousChooser runs code on.
+     */
+    struct ThreadSchedules {
+        /// The thread backend's autonomous thread.
+        ThreadSchedule autonomous;
+
+        /// The NetworkTables listener thread that handles selection changes.
+        /// This thread is shared with all other NetworkTables listeners.
+        ThreadSchedule listener;
+    };
 
     /**
-     * Adds an autonomous mode.
+     * Constructs an AutonomousChooser.
      *
-     * @param name Name of autonomous mode.
-     * @param func Autonomous mode function.
+     * The table of autonomous modes is published once and isn't copied, so it
+     * must outlive the chooser. It should be sorted by name with
+     * SortAutonomousModes() and checked with HasUniqueNames() and HasMode().
+     * An empty table is reported and replaced with one mode that does nothing,
+     * and a default name that isn't in the table is reported and replaced
+     * with the first mode's.
+     *
+     * @param context     Pointer passed to the autonomous mode functions.
+     * @param modes       Table of autonomous modes sorted by name.
+     * @param defaultName Name of autonomous mode that's run if no other
+     *                    autonomous mode is selected.
+     * @param backend     How autonomous mode functions are run.
+     * @param schedules   Scheduling settings for the autonomous and listener
+     *                    threads.
      */
-    void AddAutonomous(wpi::StringRef name, std::function<void()> func);
+    AutonomousChooser(void* context, wpi::ArrayRef<AutonomousMode> modes,
+                      std::string_view defaultName,
+                      Backend backend = Backend::kThread,
+                      const ThreadSchedules& schedules = ThreadSchedules{});
+
+    ~AutonomousChooser();
 
     /**
      * Sets the selected autonomous mode for unit testing purposes.
@@ -55,25 +95,69 @@ public:
     /**
      * Returns a list of selectable autonomous modes for unit testing purposes.
      */
-    const std::vector<std::string>& GetAutonomousNames() const;
+    std::vector<std::string> GetAutonomousNames() const;
 
     /**
      * Yield to main robot thread and wait for next chance to run.
      *
+     * If the autonomous mode is ended while it's yielded, this throws an
+     * exception that unwinds the autonomous mode function and is caught by the
+     * chooser, so autonomous mode functions don't need to check whether
+     * they're still enabled. They shouldn't catch all exceptions.
+     *
      * This function should only be called by the autonomous mode. A call by the
      * main robot thread will block indefinitely.
      */
     void YieldToMain();
 
     /**
-     * Return to main robot thread.
+     * Yields to the main robot thread until a duration has passed.
      *
      * This function should only be called by the autonomous mode.
+     *
+     * @param duration Time to wait.
+     */
+    void Wait(units::second_t duration);
+
+    /**
+     * Yields to the main robot thread until a predicate returns true or a
+     * timeout passes. The predicate is polled once per robot cycle.
+     *
+     * This function should only be called by the autonomous mode.
+     *
+     * @param pred    Predicate to poll.
+     * @param timeout Maximum time to wait.
+     * @return True if the predicate was satisfied or false if the wait timed
+     *         out.
+     */
+    template <typename Predicate>
+    bool Until(Predicate pred,
+               units::second_t timeout = units::second_t{
+                   std::numeric_limits<double>::infinity()}) {
+        auto endTime = frc2::Timer::GetFPGATimestamp() + timeout;
+        while (!pred()) {
+            if (frc2::Timer::GetFPGATimestamp() >= endTime) {
+                return false;
+            }
+            YieldToMain();
+        }
+        return true;
+    }
+
+    /**
+     * Return to main robot thread.
+     *
+     * This function should only be called by the autonomous mode. The fiber
+     * backend returns to the main robot thread when the autonomous mode
+     * function returns, so this does nothing there.
      */
     void Return();
 
     /**
      * Runs the selected autonomous mode function.
+     *
+     * If the previous autonomous mode is still running, it's ended first as
+     * if by EndAutonomous().
      */
     void AwaitStartAutonomous();
 
@@ -92,30 +176,139 @@ public:
      */
     void EndAutonomous();
 
+    /**
+     * Starts a named phase of the autonomous mode that ends when the returned
+     * scope is destroyed.
+     *
+     * The duration and number of robot cycles of each phase are printed and
+     * published when the autonomous mode ends. The name isn't copied, so it
+     * should be a string literal.
+     *
+     * @param name Name of phase.
+     */
+    PhaseProfiler::Scope Phase(std::string_view name);
+
+    /**
+     * Sets how long the autonomous mode may run between yields to the main
+     * robot thread.
+     *
+     * Each time AwaitStartAutonomous() or AwaitRunAutonomous() blocks longer
+     * than this, an overrun is counted, reported, and published along with its
+     * timestamp, duration, and autonomous mode name.
+     *
+     * @param budget Maximum time between yields.
+     */
+    void SetCycleBudget(units::second_t budget);
+
+    /**
+     * Returns the number of times the autonomous mode has exceeded its cycle
+     * budget.
+     */
+    int GetCycleOverruns() const;
+
     void InitSendable(frc::SendableBuilder& builder) override;
 
 private:
+    Backend m_backend;
+
     std::thread m_autonThread;
-    wpi::mutex m_mutex;
+
+    // wpi::mutex uses priority inheritance on the roboRIO, so a real-time main
+    // robot thread can't be starved by a lower priority thread holding it
     wpi::mutex m_autonMutex;
     std::unique_lock<wpi::mutex> m_mainLock{m_autonMutex};
     std::unique_lock<wpi::mutex> m_autonLock{m_autonMutex, std::defer_lock};
     wpi::condition_variable m_cond;
     bool m_awaitingAuton = false;
     bool m_autonRunning = false;
+    bool m_exiting = false;
+
+    // Set by EndAutonomous() so the autonomous mode unwinds the next time it's
+    // resumed
+    bool m_cancelling = false;
+
+    // Created on the first autonomous run and reset for each one after that,
+    // so its stack is only allocated once
+    std::unique_ptr<Fiber> m_autonFiber;
 
-    std::string m_defaultChoice;
-    std::string m_selectedChoice;
-    wpi::StringMap<std::function<void()>> m_choices;
-    std::vector<std::string> m_names;
-    std::function<void()>* m_selectedAuton;
+    void* m_context;
+    wpi::ArrayRef<AutonomousMode> m_modes;
+    size_t m_defaultIndex;
+    const AutonomousMode* m_selectedAuton;
+
+    // Index into m_modes of the selected autonomous mode. Names that don't
+    // match an autonomous mode select the default one.
+    std::atomic<size_t> m_selectedIndex;
 
     nt::NetworkTableEntry m_defaultEntry;
     nt::NetworkTableEntry m_optionsEntry;
     nt::NetworkTableEntry m_selectedEntry;
     nt::NetworkTableEntry m_activeEntry;
 
+    nt::NetworkTableEntry m_overrunCountEntry;
+    nt::NetworkTableEntry m_overrunTimeEntry;
+    nt::NetworkTableEntry m_overrunDurationEntry;
+    nt::NetworkTableEntry m_overrunAutonEntry;
+
+    nt::NetworkTableEntry m_phaseNamesEntry;
+    nt::NetworkTableEntry m_phaseDurationsEntry;
+    nt::NetworkTableEntry m_phaseCyclesEntry;
+
+    PhaseProfiler m_profiler;
+    bool m_profilePending = false;
+
+    units::second_t m_cycleBudget = 5_ms;
+    int m_cycleOverruns = 0;
+
     NT_EntryListener m_selectedListenerHandle;
+    ThreadSchedule m_listenerSchedule;
+    std::once_flag m_listenerScheduleFlag;
+
+    /**
+     * Thrown by YieldToMain() to unwind an autonomous mode that was ended.
+     */
+    struct Cancellation {};
+
+    /**
+     * Runs the selected autonomous mode each time one is dispatched. This is
+     * the body of the thread backend's autonomous thread.
+     */
+    void RunAutonThread();
+
+    /**
+     * Calls the selected autonomous mode function until it returns or is
+     * cancelled.
+     */
+    void RunSelectedFunc();
+
+    /**
+     * Starts the selected autonomous mode and runs it until it first yields.
+     */
+    void StartSelectedAuton();
+
+    /**
+     * Runs the selected autonomous mode until it yields again.
+     */
+    void RunSelectedAuton();
+
+    /**
+     * Makes the running autonomous mode exit.
+     */
+    void EndSelectedAuton();
+
+    /**
+     * Counts and publishes an overrun if the autonomous mode ran longer than
+     * the cycle budget.
+     *
+     * @param startTime Time at which the autonomous mode was resumed.
+     */
+    void CheckCycleBudget(units::second_t startTime);
+
+    /**
+     * Returns the index into m_modes of the autonomous mode with the given
+     * name, or the default autonomous mode's index if there isn't one.
+     */
+    size_t FindMode(std::string_view name) const;
 };
 
 }  // namespace frc3512
@@ -0,0 +1,203 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+namespace frc3512 {
+
+/**
+ * The inputs an autonomous mode observed and the outputs it commanded during
+ * one robot cycle.
+ */
+struct AutonomousFrame {
+    static constexpr uint8_t kAutonomousEnabled = 1 << 0;
+    static constexpr uint8_t kClawShooting = 1 << 1;
+
+    // Inputs sampled before the autonomous mode ran
+
+    /// FPGA timestamp in seconds.
+    double timestamp = 0.0;
+
+    /// Drivetrain::GetLeftDist() in inches.
+    float leftDist = 0.f;
+
+    /// Drivetrain::GetRightDist() in inches.
+    float rightDist = 0.f;
+
+    /// Battery voltage in volts, which scales the drivetrain's voltage
+    /// commands into motor outputs.
+    float batteryVoltage = 0.f;
+
+    /// Bitmask of kAutonomousEnabled and kClawShooting.
+    uint8_t flags = 0;
+
+    // Outputs sampled after the autonomous mode ran
+
+    /// Left drivetrain motor output from -1 to 1.
+    float leftOutput = 0.f;
+
+    /// Right drivetrain motor output from -1 to 1.
+    float rightOutput = 0.f;
+
+    /// Claw angle reference in degrees.
+    float clawReference = 0.f;
+};
+
+/**
+ * Records an autonomous mode's inputs and outputs each cycle and saves them to
+ * a compact binary file.
+ *
+ * Storage for a full autonomous period is allocated up front, and nothing is
+ * written to disk until Save() or SaveInBackground() is called, so recording is
+ * cheap enough to run every cycle.
+ *
+ * The file is a header of the magic bytes "3512AUTO", a uint32 version, and a
+ * uint32 frame count, followed by packed frames. All values are little-endian.
+ */
+class AutonomousRecorder {
+public:
+    /**
+     * Preallocates frame storage and starts the thread that writes logs for
+     * SaveInBackground().
+     */
+    AutonomousRecorder();
+
+    /**
+     * Finishes writing any log being saved in the background.
+     */
+    ~AutonomousRecorder();
+
+    AutonomousRecorder(const AutonomousRecorder&) = delete;
+    AutonomousRecorder& operator=(const AutonomousRecorder&) = delete;
+
+    /**
+     * Discards any recorded frames.
+     */
+    void Clear();
+
+    /**
+     * Appends a frame. Frames beyond the preallocated capacity are dropped.
+     */
+    void Record(const AutonomousFrame& frame);
+
+    /**
+     * Returns the recorded frames.
+     */
+    const std::vector<AutonomousFrame>& GetFrames() const;
+
+    /**
+     * Writes the recorded frames to a file.
+     *
+     * @param path Path of file.
+     * @return True on success.
+     */
+    bool Save(const std::string& path) const;
+
+    /**
+     * Hands the recorded frames to a background thread, which writes them to a
+     * new file named for the current time, and clears them.
+     *
+     * Writing to the roboRIO's flash can take tens of milliseconds, so this
+     * only swaps two preallocated buffers on the calling thread. If the
+     * previous log is still being written, the frames are discarded and an
+     * error is reported.
+     *
+     * The file is named "<prefix>-YYYYmmdd-HHMMSS.bin", with a numeric suffix
+     * if a log was already saved in the same second.
+     *
+     * @param prefix Path prefix of the file. It isn't copied, so it should be a
+     *               string literal.
+     */
+    void SaveInBackground(std::string_view prefix);
+
+    /**
+     * Waits for a log being saved in the background to be written, then
+     * returns the path of the last log that was, or an empty string if none
+     * has been.
+     */
+    std::string WaitForSave();
+
+    /**
+     * Reads frames from a file written by Save().
+     *
+     * @param path Path of file.
+     * @return The frames, or an empty vector if the file couldn't be read.
+     */
+    static std::vector<AutonomousFrame> Load(const std::string& path);
+
+private:
+    std::vector<AutonomousFrame> m_frames;
+
+    // Owned by the writer thread while m_savePending is true
+    std::vector<AutonomousFrame> m_savingFrames;
+    std::string_view m_savePrefix;
+
+    std::thread m_writerThread;
+    wpi::mutex m_writerMutex;
+    wpi::condition_variable m_writerCond;
+    bool m_savePending = false;
+    bool m_exiting = false;
+    std::string m_lastSavedPath;
+
+    /**
+     * Writes each log handed off by SaveInBackground(). This is the body of
+     * the writer thread.
+     */
+    void RunWriterThread();
+
+    /**
+     * Writes frames to a file in the format described above.
+     *
+     * @param path   Path of file.
+     * @param frames Frames to write.
+     * @return True on success.
+     */
+    static bool Write(const std::string& path,
+                      const std::vector<AutonomousFrame>& frames);
+};
+
+/**
+ * The result of replaying a recording and comparing the outputs.
+ */
+struct AutonomousReplayResult {
+    /// Number of frames replayed.
+    size_t frames = 0;
+
+    /// Number of frames whose outputs or claw state differed from the
+    /// recording.
+    size_t mismatchedFrames = 0;
+
+    /// Index of the first frame that differed, if any.
+    std::optional<size_t> firstMismatch;
+
+    /// Largest absolute difference between a recorded and replayed output.
+    double maxOutputError = 0.0;
+
+    /**
+     * Compares a replayed frame against the recorded one and accumulates the
+     * result.
+     *
+     * @param index    Index of frame.
+     * @param recorded Recorded frame.
+     * @param replayed Frame with the inputs and outputs seen during replay.
+     */
+    void Compare(size_t index, const AutonomousFrame& recorded,
+                 const AutonomousFrame& replayed);
+
+    /**
+     * Prints a summary of the result.
+     */
+    void Print() const;
+};
+
+}  // namespace frc3512
@@ -0,0 +1,114 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <string_view>
+
+namespace frc3512 {
+
+/**
+ * An entry in a table of autonomous modes.
+ */
+struct AutonomousMode {
+    /// Name of autonomous mode.
+    std::string_view name;
+
+    /// Autonomous mode function run by the chooser's thread or fiber backend.
+    /// It receives the context pointer the AutonomousChooser was constructed
+    /// with.
+    void (*func)(void* context) = nullptr;
+};
+
+namespace detail {
+
+template <typename T>
+struct MemberFunctionClass;
+
+template <typename R, typename T>
+struct MemberFunctionClass<R (T::*)()> {
+    using type = T;
+};
+
+}  // namespace detail
+
+/**
+ * Makes an autonomous mode entry that calls a member function on the chooser's
+ * context.
+ *
+ * @tparam Func Pointer to member function of the context's class.
+ * @param name  Name of autonomous mode.
+ */
+template <auto Func>
+constexpr AutonomousMode MakeAutonomousMode(std::string_view name) {
+    using T = typename detail::MemberFunctionClass<decltype(Func)>::type;
+
+    return AutonomousMode{
+        name, [](void* context) { (static_cast<T*>(context)->*Func)(); }};
+}
+
+/**
+ * Returns the table of autonomous modes sorted by name.
+ *
+ * This is meant to be evaluated at compile time so AutonomousChooser can
+ * publish the names and search them without sorting at runtime.
+ *
+ * @param modes Table of autonomous modes.
+ */
+template <size_t N>
+constexpr std::array<AutonomousMode, N> SortAutonomousModes(
+    std::array<AutonomousMode, N> modes) {
+    static_assert(N > 0, "The chooser needs at least one autonomous mode");
+
+    // Insertion sort since std::sort() isn't constexpr on all our platforms
+    for (size_t i = 1; i < N; ++i) {
+        for (size_t j = i; j > 0 && modes[j].name < modes[j - 1].name; --j) {
+            auto temp = modes[j];
+            modes[j] = modes[j - 1];
+            modes[j - 1] = temp;
+        }
+    }
+    return modes;
+}
+
+/**
+ * Returns true if no two autonomous modes in a table sorted by
+ * SortAutonomousModes() have the same name.
+ *
+ * The chooser selects modes by name, so a duplicate could never be selected.
+ * Tables should be checked with a static_assert where they're defined.
+ *
+ * @param modes Table of autonomous modes sorted by name.
+ */
+template <size_t N>
+constexpr bool HasUniqueNames(const std::array<AutonomousMode, N>& modes) {
+    for (size_t i = 1; i < N; ++i) {
+        if (modes[i].name == modes[i - 1].name) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns true if a table of autonomous modes has a mode with the given name.
+ *
+ * The chooser falls back to the first mode if its default isn't in the table,
+ * so the default name should be checked with a static_assert where the table
+ * is defined.
+ *
+ * @param modes Table of autonomous modes.
+ * @param name  Name of autonomous mode.
+ */
+template <size_t N>
+constexpr bool HasMode(const std::array<AutonomousMode, N>& modes,
+                       std::string_view name) {
+    for (const auto& mode : modes) {
+        if (mode.name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace frc3512
@@ -0,0 +1,84 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+
+namespace frc3512 {
+
+/**
+ * A stackful coroutine that runs a function on its own stack within the
+ * calling thread.
+ *
+ * Control is transferred with a user-space stack switch, so unlike handing off
+ * to another thread, switching between the caller and the fiber doesn't
+ * involve the kernel scheduler.
+ */
+class Fiber {
+public:
+    static constexpr size_t kDefaultStackSize = 256 * 1024;
+
+    /**
+     * Constructs a fiber. The function doesn't start running until the first
+     * call to Resume().
+     *
+     * The stack is allocated here and left uninitialized, and it's reused if
+     * the fiber is restarted with Reset().
+     *
+     * @param func      Function to run in the fiber.
+     * @param stackSize Size of the fiber's stack in bytes.
+     */
+    explicit Fiber(std::function<void()> func,
+                   size_t stackSize = kDefaultStackSize);
+
+    ~Fiber();
+
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    /**
+     * Replaces the fiber's function so the next call to Resume() runs it from
+     * the start on the same stack.
+     *
+     * This function should only be called when the fiber hasn't been resumed
+     * yet or its function has returned.
+     *
+     * @param func Function to run in the fiber.
+     */
+    void Reset(std::function<void()> func);
+
+    /**
+     * Switches to the fiber and runs it until it calls Suspend() or its
+     * function returns.
+     *
+     * If the fiber's function threw an exception, it's rethrown here.
+     */
+    void Resume();
+
+    /**
+     * Switches from the fiber back to the caller of Resume().
+     *
+     * This function should only be called from within the fiber.
+     */
+    void Suspend();
+
+    /**
+     * Returns true if the fiber's function has returned.
+     */
+    bool IsDone() const;
+
+private:
+    struct Context;
+
+    std::function<void()> m_func;
+    std::unique_ptr<Context> m_context;
+    std::exception_ptr m_exception;
+    bool m_done = false;
+
+    static void Entry(Fiber* fiber);
+};
+
+}  // namespace frc3512
@@ -0,0 +1,89 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+namespace frc3512 {
+
+/**
+ * Returns the cosine of an angle in radians.
+ *
+ * Unlike std::cos(), this can be evaluated at compile time. It's accurate to
+ * within a few ULP, but it's much slower than std::cos() at runtime, so it's
+ * meant for building tables.
+ */
+constexpr double ConstexprCos(double x) {
+    constexpr double kPi = 3.14159265358979323846;
+
+    // Reduce to [-pi, pi] where the series converges quickly
+    x -= static_cast<long long>(x / (2.0 * kPi)) * 2.0 * kPi;
+    if (x > kPi) {
+        x -= 2.0 * kPi;
+    } else if (x < -kPi) {
+        x += 2.0 * kPi;
+    }
+
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 30; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * A function sampled at evenly spaced points over a range and evaluated by
+ * linear interpolation.
+ *
+ * Constructing the table is constexpr, so the samples can be computed at
+ * compile time. Evaluating it is a clamp, a multiply, and one lerp, so its
+ * cost is the same for every input.
+ *
+ * The interpolation error is at most h^2 / 8 * max|f''| where h is the sample
+ * spacing.
+ *
+ * @tparam N Number of samples. Must be at least 2.
+ */
+template <size_t N>
+class InterpolatingTable {
+    static_assert(N >= 2, "InterpolatingTable needs at least two samples");
+
+public:
+    /**
+     * Samples a function over [min, max].
+     *
+     * @param min Lower bound of range.
+     * @param max Upper bound of range.
+     * @param f   Function to sample. Must be constexpr-callable for the table
+     *            to be built at compile time.
+     */
+    template <typename F>
+    constexpr InterpolatingTable(double min, double max, F f)
+        : m_min{min}, m_max{max}, m_invSpacing{(N - 1) / (max - min)} {
+        for (size_t i = 0; i < N; ++i) {
+            m_samples[i] = f(min + i * (max - min) / (N - 1));
+        }
+    }
+
+    /**
+     * Returns the interpolated function value at x. Inputs outside the range
+     * are clamped to it.
+     */
+    constexpr double operator()(double x) const {
+        double pos = (std::clamp(x, m_min, m_max) - m_min) * m_invSpacing;
+        size_t i = std::min(static_cast<size_t>(pos), N - 2);
+        double t = pos - i;
+        return m_samples[i] + t * (m_samples[i + 1] - m_samples[i]);
+    }
+
+private:
+    double m_min;
+    double m_max;
+    double m_invSpacing;
+    std::array<double, N> m_samples{};
+};
+
+}  // namespace frc3512
@@ -0,0 +1,139 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <frc/smartdashboard/Sendable.h>
+#include <frc/smartdashboard/SendableBuilder.h>
+#include <networktables/NetworkTableEntry.h>
+#include <units/time.h>
+
+namespace frc3512 {
+
+/**
+ * A fixed-size histogram of loop execution times.
+ *
+ * Samples are sorted into 10 us buckets up to 20.48 ms, with one more bucket
+ * for anything longer. Recording a sample is a single relaxed atomic increment
+ * plus a compare-exchange on the maximum, so it never blocks and never
+ * allocates.
+ */
+class LoopTimingHistogram {
+public:
+    static constexpr size_t kBuckets = 2048;
+    static constexpr std::chrono::nanoseconds kBucketWidth{10000};
+
+    /**
+     * Statistics for the samples recorded since the last TakeSnapshot().
+     */
+    struct Snapshot {
+        uint32_t count = 0;
+        units::second_t p50 = 0_s;
+        units::second_t p95 = 0_s;
+        units::second_t p99 = 0_s;
+        units::second_t max = 0_s;
+    };
+
+    /**
+     * Adds a sample.
+     */
+    void Record(std::chrono::nanoseconds duration);
+
+    /**
+     * Returns statistics for the samples recorded so far and clears them.
+     *
+     * Percentiles are the upper edge of the bucket containing them, so they're
+     * accurate to one bucket width. The maximum is exact.
+     */
+    Snapshot TakeSnapshot();
+
+private:
+    // The last bucket holds every sample past the end of the range
+    std::array<std::atomic<uint32_t>, kBuckets + 1> m_buckets{};
+    std::atomic<int64_t> m_max{0};
+};
+
+/**
+ * Times a robot loop callback and publishes its execution time percentiles and
+ * overrun count to NetworkTables.
+ */
+class LoopTimer : public frc::Sendable {
+public:
+    /**
+     * Records the time from its construction to its destruction.
+     */
+    class [[nodiscard]] Scope {
+    public:
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        friend class LoopTimer;
+
+        LoopTimer* m_timer;
+        std::chrono::steady_clock::time_point m_startTime;
+
+        explicit Scope(LoopTimer* timer);
+    };
+
+    /**
+     * Constructs a LoopTimer.
+     *
+     * @param name   Name of callback. The timer is published to SmartDashboard
+     *               under "Loop timing/<name>" on the first call to
+     *               Publish(), which keeps it out of robot startup.
+     * @param period Period at which the callback is run. Runs that take longer
+     *               are counted as overruns.
+     */
+    LoopTimer(std::string_view name, units::second_t period);
+
+    LoopTimer(const LoopTimer&) = delete;
+    LoopTimer& operator=(const LoopTimer&) = delete;
+
+    /**
+     * Starts timing a callback run that ends when the returned scope is
+     * destroyed.
+     */
+    Scope Time();
+
+    /**
+     * Publishes statistics for the runs timed since the last call, then
+     * clears them.
+     *
+     * Callbacks that didn't run in that window, like TeleopPeriodic() during
+     * autonomous, publish a count of zero and keep their last percentiles.
+     */
+    void Publish();
+
+    /**
+     * Returns the number of runs that took longer than the period.
+     */
+    uint32_t GetOverruns() const;
+
+    void InitSendable(frc::SendableBuilder& builder) override;
+
+private:
+    LoopTimingHistogram m_histogram;
+    std::string m_name;
+    bool m_isPublished = false;
+    std::chrono::nanoseconds m_period;
+    std::atomic<uint32_t> m_overruns{0};
+
+    nt::NetworkTableEntry m_countEntry;
+    nt::NetworkTableEntry m_overrunsEntry;
+    nt::NetworkTableEntry m_p50Entry;
+    nt::NetworkTableEntry m_p95Entry;
+    nt::NetworkTableEntry m_p99Entry;
+    nt::NetworkTableEntry m_maxEntry;
+};
+
+}  // namespace frc3512
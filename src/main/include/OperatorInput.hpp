@@ -0,0 +1,107 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+
+#include <hal/DriverStation.h>
+
+namespace frc3512 {
+
+/**
+ * One joystick's axes and buttons as of the start of a robot cycle.
+ *
+ * Buttons are stored as bitmasks with bit n - 1 for button n, so edges for all
+ * buttons are computed with a couple of bitwise operations.
+ */
+struct JoystickSnapshot {
+    std::array<float, HAL_kMaxJoystickAxes> axes{};
+
+    /// Buttons held down this cycle.
+    uint32_t buttons = 0;
+
+    /// Buttons that went down since the last cycle.
+    uint32_t pressed = 0;
+
+    /// Buttons that went up since the last cycle.
+    uint32_t released = 0;
+
+    /**
+     * Returns the value of an axis from -1 to 1, or 0 if the axis doesn't
+     * exist.
+     */
+    double GetRawAxis(int axis) const {
+        if (axis < 0 || axis >= static_cast<int>(axes.size())) {
+            return 0.0;
+        }
+        return axes[axis];
+    }
+
+    /// Returns the X axis, which is axis 0 like frc::Joystick::GetX().
+    double GetX() const { return GetRawAxis(0); }
+
+    /// Returns the Y axis, which is axis 1 like frc::Joystick::GetY().
+    double GetY() const { return GetRawAxis(1); }
+
+    /// Returns the Z axis, which is axis 2 like frc::Joystick::GetZ().
+    double GetZ() const { return GetRawAxis(2); }
+
+    /**
+     * Returns true if the button is held down. Buttons are numbered from 1.
+     */
+    bool GetRawButton(int button) const { return buttons & Mask(button); }
+
+    /**
+     * Returns true if the button went down since the last cycle.
+     */
+    bool GetRawButtonPressed(int button) const {
+        return pressed & Mask(button);
+    }
+
+    /**
+     * Returns true if the button went up since the last cycle.
+     */
+    bool GetRawButtonReleased(int button) const {
+        return released & Mask(button);
+    }
+
+private:
+    static constexpr uint32_t Mask(int button) {
+        if (button < 1 || button > 32) {
+            return 0;
+        }
+        return uint32_t{1} << (button - 1);
+    }
+};
+
+/**
+ * Reads every joystick once per robot cycle and shares the result.
+ *
+ * Unlike frc::Joystick::GetRawButtonPressed(), reading an edge from a snapshot
+ * doesn't consume it, so every subsystem sees the same presses.
+ */
+class OperatorInput {
+public:
+    static constexpr int kJoysticks = HAL_kMaxJoysticks;
+
+    /**
+     * Reads all joysticks and computes button edges relative to the previous
+     * call. This should be called once at the start of each robot cycle.
+     */
+    void Update();
+
+    /**
+     * Returns the snapshot for a joystick port.
+     */
+    const JoystickSnapshot& GetJoystick(int port) const;
+
+private:
+    std::array<JoystickSnapshot, kJoysticks> m_joysticks;
+
+    // Returned for out-of-range ports
+    JoystickSnapshot m_empty;
+};
+
+}  // namespace frc3512
@@ -0,0 +1,111 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <units/time.h>
+
+namespace frc3512 {
+
+/**
+ * Records how long named phases of an autonomous mode take in time and robot
+ * cycles.
+ *
+ * Records are kept in a fixed-size buffer, so marking a phase doesn't
+ * allocate. Phases beyond the buffer's capacity are counted but not recorded.
+ */
+class PhaseProfiler {
+public:
+    static constexpr size_t kMaxPhases = 64;
+
+    /**
+     * Records a phase's exit time when it goes out of scope.
+     */
+    class [[nodiscard]] Scope {
+    public:
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        friend class PhaseProfiler;
+
+        PhaseProfiler* m_profiler;
+        size_t m_index;
+
+        Scope(PhaseProfiler* profiler, size_t index);
+    };
+
+    /**
+     * Starts a phase that ends when the returned scope is destroyed.
+     *
+     * Phases may be nested. The name isn't copied, so it should be a string
+     * literal.
+     *
+     * @param name Name of phase.
+     */
+    Scope Phase(std::string_view name);
+
+    /**
+     * Advances the cycle count. This should be called once per robot cycle.
+     */
+    void NextCycle();
+
+    /**
+     * Clears all recorded phases and the cycle count.
+     */
+    void Reset();
+
+    /**
+     * Returns true if no phases have been recorded since the last Reset().
+     */
+    bool IsEmpty() const;
+
+    /**
+     * Prints a table of the recorded phases with their durations and cycle
+     * counts.
+     */
+    void Print() const;
+
+    /**
+     * Returns the names of the recorded phases, indented by nesting depth.
+     */
+    std::vector<std::string> GetNames() const;
+
+    /**
+     * Returns the durations of the recorded phases in seconds.
+     */
+    std::vector<double> GetDurations() const;
+
+    /**
+     * Returns the number of robot cycles each recorded phase spanned.
+     */
+    std::vector<double> GetCycles() const;
+
+private:
+    struct Record {
+        std::string_view name;
+        int depth;
+        units::second_t startTime;
+        units::second_t endTime;
+        uint32_t startCycle;
+        uint32_t endCycle;
+    };
+
+    std::array<Record, kMaxPhases> m_records;
+    size_t m_size = 0;
+    size_t m_dropped = 0;
+    int m_depth = 0;
+    uint32_t m_cycle = 0;
+
+    void EndPhase(size_t index);
+};
+
+}  // namespace frc3512
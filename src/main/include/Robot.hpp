@@ -2,9 +2,17 @@
 
 #pragma once
 
+#include <string>
+#include <string_view>
+
 #include <frc/TimedRobot.h>
 
 #include "AutonomousChooser.hpp"
+#include "AutonomousLog.hpp"
+#include "LoopTimer.hpp"
+#include "OperatorInput.hpp"
+#include "StartupProfiler.hpp"
+#include "ThreadSchedule.hpp"
 #include "subsystems/Claw.hpp"
 #include "subsystems/Drivetrain.hpp"
 
@@ -12,25 +20,123 @@ class Robot : public frc::TimedRobot {
 public:
     Robot();
 
+    /**
+     * Applies the main thread's schedule on the roboRIO, then runs the main
+     * robot loop on the calling thread.
+     */
+    void StartCompetition() override;
+
     void DisabledInit() override;
     void AutonomousInit() override;
     void TeleopInit() override;
     void TestInit() override;
 
     void RobotPeriodic() override;
+    void DisabledPeriodic() override;
     void AutonomousPeriodic() override;
     void TeleopPeriodic() override;
     void TestPeriodic() override;
+    void SimulationPeriodic() override;
 
     bool CheckReflectiveStrips();
 
+    /**
+     * Selects the autonomous mode to run next.
+     *
+     * @param name Name of autonomous mode.
+     */
+    void SelectAutonomous(std::string_view name);
+
+    const Drivetrain& GetDrivetrain() const;
+    const Claw& GetClaw() const;
+
+    /**
+     * Waits for an autonomous log being saved to be written, then returns the
+     * path of the last one that was, or an empty string if none has been.
+     */
+    std::string WaitForAutonomousLog();
+
     void AutonRightLeft();
     void AutonDriveForward();
     void AutonSide();
 
+    /**
+     * Replays a recorded autonomous mode against the recorded sensor inputs
+     * and compares the outputs it commands with the recorded ones.
+     *
+     * This steps simulated time through the recorded timestamps and sets the
+     * simulated driver station to the recorded state, so it should only be
+     * called in desktop simulation while the main robot loop isn't running.
+     * The robot program does this when run with "--replay <mode> <log>".
+     *
+     * @param modeName Name of autonomous mode that was recorded.
+     * @param path     Path of file written by AutonomousRecorder::Save().
+     */
+    frc3512::AutonomousReplayResult ReplayAutonomous(std::string_view modeName,
+                                                     const std::string& path);
+
 private:
+    // The control loop runs on core 1 so the NetworkTables listener, which
+    // only handles dashboard updates, can't preempt it
+    static constexpr frc3512::ThreadSchedule kMainThreadSchedule{15, 1};
+    static constexpr frc3512::ThreadSchedule kAutonThreadSchedule{15, 1};
+    static constexpr frc3512::ThreadSchedule kListenerThreadSchedule{0, 0};
+
+    // The claw controller preempts the main thread so it runs on time
+    static constexpr frc3512::ThreadSchedule kClawThreadSchedule{20, 1};
+
+    // Loop timing is published halfway between main loop iterations
+    static constexpr units::second_t kLoopTimingOffset = kDefaultPeriod / 2;
+
+    // Each StartupMark ends the startup phase that constructs the members
+    // declared since the previous one
+    frc3512::StartupMark m_halStartup{"HAL and TimedRobot"};
+
+    frc3512::LoopTimer m_robotPeriodicTimer{"RobotPeriodic", kDefaultPeriod};
+    frc3512::LoopTimer m_autonomousPeriodicTimer{"AutonomousPeriodic",
+                                                 kDefaultPeriod};
+    frc3512::LoopTimer m_teleopPeriodicTimer{"TeleopPeriodic", kDefaultPeriod};
+    frc3512::LoopTimer m_testPeriodicTimer{"TestPeriodic", kDefaultPeriod};
+
     Drivetrain m_drivetrain;
-    Claw m_claw;
+    frc3512::StartupMark m_drivetrainStartup{"Drivetrain"};
+
+    Claw m_claw{OnRobot(kClawThreadSchedule)};
+    frc3512::StartupMark m_clawStartup{"Claw"};
+
+    frc3512::AutonomousChooser m_autonChooser;
+    frc3512::AutonomousRecorder m_autonRecorder;
+    frc3512::StartupMark m_autonStartup{"autonomous chooser and NT publish"};
+
+    bool m_isFirstLoop = true;
+
+    // TimedRobot runs the current mode's periodic function before
+    // RobotPeriodic(), so each mode's periodic function updates this first
+    frc3512::OperatorInput m_input;
+
+    /**
+     * Returns the given schedule on the roboRIO and the default schedule
+     * elsewhere.
+     *
+     * Desktop simulation and tests don't run with real-time privileges, so
+     * applying the roboRIO's schedules there would only report errors.
+     */
+    static frc3512::ThreadSchedule OnRobot(
+        const frc3512::ThreadSchedule& schedule);
+
+    /**
+     * Returns a frame with the inputs the autonomous mode is about to observe.
+     */
+    frc3512::AutonomousFrame SampleAutonomousInputs();
+
+    /**
+     * Fills in the outputs the autonomous mode commanded this cycle.
+     */
+    void SampleAutonomousOutputs(frc3512::AutonomousFrame& frame);
 
-    frc3512::AutonomousChooser m_autonChooser{"No-op", [] {}};
+    /**
+     * Starts writing the recorded autonomous frames to a new timestamped file
+     * in the background, if there are any, and clears them.
+     */
+    void SaveAutonomousLog();
 };
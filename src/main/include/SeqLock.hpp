@@ -0,0 +1,89 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace frc3512 {
+
+/**
+ * Publishes a value from one writer thread to any number of reader threads
+ * without locking.
+ *
+ * The writer never waits. Readers retry if they overlap with a write, which
+ * is rare when writes are short and infrequent relative to reads.
+ *
+ * The value is stored as an array of atomic words so overlapping reads and
+ * writes aren't a data race; a torn read is detected by the sequence number
+ * and discarded.
+ *
+ * @tparam T A trivially copyable type.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() { Store(T{}); }
+
+    explicit SeqLock(const T& value) { Store(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /**
+     * Publishes a new value. Only one thread may call this.
+     */
+    void Store(const T& value) {
+        std::array<uint32_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < kWords; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * Returns the most recently published value.
+     */
+    T Load() const {
+        std::array<uint32_t, kWords> words;
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = m_seq.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_seq.load(std::memory_order_relaxed);
+        } while (before != after || (before & 1) != 0);
+
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords =
+        (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    // Odd while a write is in progress
+    std::atomic<uint32_t> m_seq{0};
+
+    std::array<std::atomic<uint32_t>, kWords> m_words{};
+};
+
+}  // namespace frc3512
@@ -0,0 +1,155 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <initializer_list>
+#include <vector>
+
+#include <frc/Solenoid.h>
+#include <frc/smartdashboard/Sendable.h>
+#include <frc/smartdashboard/SendableBuilder.h>
+#include <units/time.h>
+
+namespace frc3512 {
+
+/**
+ * Solenoids on one PCM that are switched together.
+ *
+ * Setting each frc::Solenoid separately sends one PCM update per channel, so
+ * their pistons fire at slightly different times. This computes the group's
+ * channel mask up front and switches the whole group with a single write of
+ * the module's solenoid states.
+ *
+ * That write covers every channel on the module, so the commanded state of
+ * each channel is kept in one place per module and shared by every
+ * SolenoidGroup on it. The PCM's status frame isn't used because it lags the
+ * commands. Every solenoid on a module should be driven through a
+ * SolenoidGroup, even a lone one, since a channel set through frc::Solenoid
+ * isn't in the commanded state and is overwritten by the next group write.
+ *
+ * Setting a group to the state it's already commanded to returns without
+ * locking or writing, so it's cheap to call every loop iteration.
+ *
+ * How long each HAL call took is published as telemetry. That's only the time
+ * to queue the CAN frame, not actuation skew or when the pistons moved.
+ */
+class SolenoidGroup : public frc::Sendable {
+public:
+    /**
+     * Constructs a SolenoidGroup on the default PCM.
+     *
+     * @param channels Solenoid channels. Channels out of the PCM's range are
+     *                 reported and ignored.
+     */
+    explicit SolenoidGroup(std::initializer_list<int> channels);
+
+    /**
+     * Constructs a SolenoidGroup.
+     *
+     * @param module   PCM CAN ID.
+     * @param channels Solenoid channels. Channels out of the PCM's range are
+     *                 reported and ignored.
+     */
+    SolenoidGroup(int module, std::initializer_list<int> channels);
+
+    SolenoidGroup(const SolenoidGroup&) = delete;
+    SolenoidGroup& operator=(const SolenoidGroup&) = delete;
+
+    /**
+     * Switches every solenoid in the group at once.
+     */
+    void Set(bool on);
+
+    /**
+     * Switches one solenoid in the group, leaving the rest unchanged.
+     *
+     * @param index Index of solenoid in the order the channels were given.
+     * @param on    True to energize the solenoid.
+     */
+    void Set(size_t index, bool on);
+
+    /**
+     * Returns true if every solenoid in the group is commanded on.
+     */
+    bool Get() const;
+
+    /**
+     * Returns true if one solenoid in the group is commanded on.
+     *
+     * @param index Index of solenoid in the order the channels were given.
+     */
+    bool Get(size_t index) const;
+
+    /**
+     * Returns true if the PCM reports one solenoid in the group as energized.
+     *
+     * This reads the PCM's status frame, which lags the commanded state by up
+     * to the frame's period.
+     *
+     * @param index Index of solenoid in the order the channels were given.
+     */
+    bool GetReported(size_t index) const;
+
+    /**
+     * Returns true if the PCM has disabled one solenoid in the group for a
+     * short circuit or reports a fault on the solenoid supply.
+     *
+     * @param index Index of solenoid in the order the channels were given.
+     */
+    bool HasFault(size_t index) const;
+
+    /**
+     * Returns a solenoid's channel.
+     *
+     * @param index Index of solenoid in the order the channels were given.
+     */
+    int GetChannel(size_t index) const;
+
+    /**
+     * Returns the number of solenoids in the group.
+     */
+    size_t Size() const;
+
+    /**
+     * Returns how long the last HAL call to write the module took.
+     */
+    units::second_t GetLastHALCallDuration() const;
+
+    /**
+     * Returns the longest a HAL call to write the module has taken.
+     */
+    units::second_t GetMaxHALCallDuration() const;
+
+    void InitSendable(frc::SendableBuilder& builder) override;
+
+private:
+    struct Module;
+
+    int m_module;
+    Module* m_moduleState = nullptr;
+
+    // Only constructed to reserve the channels and report invalid ones
+    std::vector<frc::Solenoid> m_solenoids;
+
+    // Bit i is set if channel i on the module is in the group
+    uint32_t m_mask = 0;
+
+    // Call durations are written by whichever thread sets the group and read
+    // by the NetworkTables update, so they're stored in nanoseconds in atomics
+    std::atomic<int64_t> m_lastHALCallDuration{0};
+    std::atomic<int64_t> m_maxHALCallDuration{0};
+    std::atomic<uint32_t> m_writes{0};
+
+    /**
+     * Sets the channels in mask to on and writes them with the commanded
+     * states of the module's other channels.
+     *
+     * Does nothing if the channels in mask are already commanded to on.
+     */
+    void Write(uint32_t mask, bool on);
+};
+
+}  // namespace frc3512
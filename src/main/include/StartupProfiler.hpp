@@ -0,0 +1,58 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace frc3512 {
+
+/**
+ * Records how long each phase of robot program startup takes.
+ *
+ * Phases are contiguous: each call to Mark() ends the phase that started at
+ * the previous call. The first phase starts when the process was created, so
+ * it covers loading and static initialization. Timestamps come from
+ * steady_clock because HAL isn't initialized for the earliest phases.
+ */
+class StartupProfiler {
+public:
+    static constexpr size_t kMaxPhases = 16;
+
+    StartupProfiler() = delete;
+
+    /**
+     * Ends the current phase and names it.
+     *
+     * The name isn't copied, so it should be a string literal.
+     *
+     * @param name Name of phase that just ended.
+     */
+    static void Mark(std::string_view name);
+
+    /**
+     * Discards the recorded phases and starts a new phase now.
+     *
+     * The recorded phases are shared by the whole process, so this should be
+     * called before constructing another robot in the same process.
+     */
+    static void Reset();
+
+    /**
+     * Prints a table of the recorded phases and the total startup time.
+     */
+    static void Print();
+};
+
+/**
+ * Calls StartupProfiler::Mark() when constructed.
+ *
+ * Declaring one between class members marks the end of the members declared
+ * before it.
+ */
+class StartupMark {
+public:
+    explicit StartupMark(std::string_view name) { StartupProfiler::Mark(name); }
+};
+
+}  // namespace frc3512
@@ -0,0 +1,49 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <string>
+#include <thread>
+
+namespace frc3512 {
+
+/**
+ * Scheduling settings for a thread owned by the robot program.
+ */
+struct ThreadSchedule {
+    /// SCHED_FIFO priority from 1 (lowest) to 99 (highest), or 0 to leave the
+    /// thread at the default non-real-time priority.
+    int priority = 0;
+
+    /// CPU core to pin the thread to, or -1 to let the scheduler pick.
+    int core = -1;
+};
+
+/**
+ * Applies scheduling settings to the calling thread.
+ *
+ * The applied settings, or the reason they couldn't be applied, are reported
+ * to the console.
+ *
+ * @param name     Name of the thread for the report.
+ * @param schedule Scheduling settings.
+ * @return True if all the settings were applied.
+ */
+bool ApplyThreadSchedule(const std::string& name,
+                         const ThreadSchedule& schedule);
+
+/**
+ * Applies scheduling settings to the given thread.
+ *
+ * The applied settings, or the reason they couldn't be applied, are reported
+ * to the console.
+ *
+ * @param thread   Thread to schedule.
+ * @param name     Name of the thread for the report.
+ * @param schedule Scheduling settings.
+ * @return True if all the settings were applied.
+ */
+bool ApplyThreadSchedule(std::thread& thread, const std::string& name,
+                         const ThreadSchedule& schedule);
+
+}  // namespace frc3512
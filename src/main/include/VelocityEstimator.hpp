@@ -0,0 +1,165 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include <units/time.h>
+
+namespace frc3512 {
+
+/**
+ * Estimates velocity from the last N timestamped position samples.
+ *
+ * Samples are kept in a ring buffer of fixed capacity, so adding one and
+ * computing an estimate never allocate. Since each sample carries its own
+ * timestamp, the estimates stay correct when the loop period jitters or
+ * changes.
+ *
+ * Differentiating one pair of encoder readings amplifies quantization noise
+ * when only a few counts pass per period. The estimates here use the whole
+ * window instead:
+ *
+ * - MovingAverage() is the displacement over the window divided by its
+ *   duration. It's the cheapest.
+ * - Median() is the median of the rates between consecutive samples. It
+ *   rejects single bad readings.
+ * - LeastSquaresSlope() is the slope of the line that best fits the window.
+ *   It's the least noisy when the velocity is roughly constant over the
+ *   window.
+ *
+ * All estimates lag by about half the window's duration.
+ *
+ * @tparam N Number of samples kept. Must be at least 2.
+ */
+template <size_t N>
+class VelocityEstimator {
+    static_assert(N >= 2, "VelocityEstimator needs at least two samples");
+
+public:
+    /**
+     * Adds a sample, replacing the oldest if the buffer is full.
+     *
+     * @param timestamp Time the position was measured. Must be later than the
+     *                  previous sample's.
+     * @param position  Position in any unit. Velocities are returned in that
+     *                  unit per second.
+     */
+    void Add(units::second_t timestamp, double position) {
+        m_samples[m_head] = Sample{timestamp.to<double>(), position};
+        m_head = (m_head + 1) % N;
+        m_size = std::min(m_size + 1, N);
+    }
+
+    /**
+     * Discards all samples.
+     */
+    void Clear() {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    /**
+     * Returns the number of samples held.
+     */
+    size_t Size() const { return m_size; }
+
+    /**
+     * Returns the average velocity over the window, or 0 with fewer than two
+     * samples.
+     */
+    double MovingAverage() const {
+        if (m_size < 2) {
+            return 0.0;
+        }
+
+        const auto& oldest = At(0);
+        const auto& newest = At(m_size - 1);
+        return (newest.position - oldest.position) /
+               (newest.time - oldest.time);
+    }
+
+    /**
+     * Returns the median of the velocities between consecutive samples, or 0
+     * with fewer than two samples.
+     */
+    double Median() const {
+        if (m_size < 2) {
+            return 0.0;
+        }
+
+        std::array<double, N - 1> rates;
+        size_t count = m_size - 1;
+        for (size_t i = 0; i < count; ++i) {
+            const auto& a = At(i);
+            const auto& b = At(i + 1);
+            rates[i] = (b.position - a.position) / (b.time - a.time);
+        }
+
+        auto middle = rates.begin() + count / 2;
+        std::nth_element(rates.begin(), middle, rates.begin() + count);
+        if (count % 2 == 1) {
+            return *middle;
+        }
+
+        // With an even count, the other middle element is the largest of the
+        // lower half
+        double lower = *std::max_element(rates.begin(), middle);
+        return (lower + *middle) / 2.0;
+    }
+
+    /**
+     * Returns the slope of the least-squares line through the samples, or 0
+     * with fewer than two samples.
+     */
+    double LeastSquaresSlope() const {
+        if (m_size < 2) {
+            return 0.0;
+        }
+
+        // Times are taken relative to the newest sample so their squares
+        // don't lose precision when the FPGA timestamp is large
+        double t0 = At(m_size - 1).time;
+        double meanT = 0.0;
+        double meanX = 0.0;
+        for (size_t i = 0; i < m_size; ++i) {
+            meanT += At(i).time - t0;
+            meanX += At(i).position;
+        }
+        meanT /= m_size;
+        meanX /= m_size;
+
+        double covariance = 0.0;
+        double variance = 0.0;
+        for (size_t i = 0; i < m_size; ++i) {
+            double dt = At(i).time - t0 - meanT;
+            covariance += dt * (At(i).position - meanX);
+            variance += dt * dt;
+        }
+
+        if (variance == 0.0) {
+            return 0.0;
+        }
+        return covariance / variance;
+    }
+
+private:
+    struct Sample {
+        double time;
+        double position;
+    };
+
+    std::array<Sample, N> m_samples{};
+    size_t m_head = 0;
+    size_t m_size = 0;
+
+    /**
+     * Returns the i-th oldest sample.
+     */
+    const Sample& At(size_t i) const {
+        return m_samples[(m_head + N - m_size + i) % N];
+    }
+};
+
+}  // namespace frc3512
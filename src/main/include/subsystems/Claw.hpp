@@ -2,23 +2,230 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
 #include <vector>
 
 #include <frc/DigitalInput.h>
 #include <frc/Encoder.h>
+#include <frc/Notifier.h>
 #include <frc/Relay.h>
-#include <frc/Solenoid.h>
 #include <frc/Talon.h>
 #include <frc/controller/PIDController.h>
+#include <frc/simulation/DIOSim.h>
+#include <frc/simulation/EncoderSim.h>
+#include <frc/simulation/PWMSim.h>
+#include <frc/simulation/SingleJointedArmSim.h>
+#include <frc/trajectory/TrapezoidProfile.h>
 #include <frc2/Timer.h>
 #include <units/angle.h>
+#include <units/angular_acceleration.h>
+#include <units/angular_velocity.h>
+#include <units/length.h>
+#include <units/mass.h>
+#include <units/time.h>
+
+#include "LoopTimer.hpp"
+#include "OperatorInput.hpp"
+#include "SeqLock.hpp"
+#include "SolenoidGroup.hpp"
+#include "ThreadSchedule.hpp"
+#include "VelocityEstimator.hpp"
 
+/**
+ * The claw's angle controller and intake wheel run on a dedicated real-time
+ * thread every kDt seconds. The shooter sequence runs on another that wakes
+ * exactly at each step's deadline.
+ *
+ * Other threads never take a lock to talk to it. Commands are handed over
+ * through atomics the controller polls once per iteration, and the
+ * controller's state is published back through a SeqLock. The controller
+ * thread is also the only one that sets the collector arm, since the operator,
+ * the shooter sequence and the zero switch all move it.
+ */
 class Claw {
 public:
-    Claw();
+    /// Period of the controller thread.
+    static constexpr units::second_t kDt = 5_ms;
+
+    /// Angle controller gains in output per degree.
+    static constexpr double kP = 0.098;
+    static constexpr double kI = 0.08;
+    static constexpr double kD = 0.01;
+
+    /// Feedforward gain.
+    static constexpr double kK = 0.238;
+
+    /// Offset in degrees from the encoder angle to the feedforward's cosine
+    /// argument.
+    static constexpr double kL = 69.0;
+
+    /// Profile constraints, chosen to keep the claw's Talon out of saturation.
+    static constexpr auto kMaxVelocity = 180_deg_per_s;
+    static constexpr auto kMaxAcceleration = 360_deg_per_s_sq;
+
+    /// Goal in degrees the claw is driven to when it's supposed to be at zero
+    /// but the zero switch is open, which means the encoder has drifted. The
+    /// hard stop at the switch halts the arm before it gets there, and the
+    /// switch tripping resets the encoder and the goal to zero.
+    static constexpr double kRehomeGoal = -30.0;
+
+    /// Maximum velocity of the move to kRehomeGoal. This matches the rate of
+    /// the old nudge, which lowered the goal 5 degrees every 20 ms robot loop
+    /// iteration.
+    static constexpr auto kRehomeVelocity = 250_deg_per_s;
+
+    /// Simulation model parameters. The reduction matches the encoder's
+    /// distance per pulse; the arm's length and mass are estimates.
+    static constexpr double kGearing = 71.0 * 44.0 / 14.0;
+    static constexpr auto kArmLength = 0.6_m;
+    static constexpr auto kArmMass = 4_kg;
+
+    /// Number of actuators the self-test checks: the four shooter solenoids
+    /// followed by the vacuum.
+    static constexpr size_t kTestActuators = 5;
+
+    /// How long the self-test holds each actuator state so it can be seen
+    /// from the pit.
+    static constexpr units::second_t kTestStepDuration = 1.5_s;
+
+    /**
+     * Self-test result for one actuator.
+     */
+    struct ActuatorTestResult {
+        /// True once the actuator has been switched on and back off.
+        bool tested = false;
+
+        /// False for actuators without feedback, like the vacuum's relay.
+        /// They can only be checked by watching them during the test.
+        bool sensed = true;
+
+        /// False if the actuator's state ever read back differently than
+        /// commanded or the PCM reported a fault on it. Always false for
+        /// actuators that aren't sensed.
+        bool passed = true;
+
+        /// How long the actuator was last held on. Much longer than
+        /// kTestStepDuration means the loop stalled.
+        units::second_t onTime = 0_s;
+    };
+
+    /// Range of encoder angles in degrees covered by FeedforwardCos(). This is
+    /// the claw's full travel plus margin for overshoot past the stops.
+    static constexpr double kMinFeedforwardAngle = -20.0;
+    static constexpr double kMaxFeedforwardAngle = 220.0;
+
+    /**
+     * The claw's angle controller: a trapezoid profile to the goal, PID
+     * feedback, the gravity feedforward, and re-homing on the zero switch.
+     *
+     * Claw runs one on its controller thread. The offline tuner runs the same
+     * class with candidate gains against the arm model, so the gains it finds
+     * are tuned against this controller rather than a copy of it.
+     */
+    class AngleController {
+    public:
+        /**
+         * Controller and feedforward gains.
+         */
+        struct Gains {
+            double kP;
+            double kI;
+            double kD;
+            double kK;
+        };
+
+        /**
+         * Motor output for one controller iteration.
+         */
+        struct Output {
+            /// Output to the claw's motor.
+            double motor;
+
+            /// True if the zero switch tripped at a goal of zero or below, in
+            /// which case the controller was reset and the caller should
+            /// reset the encoder.
+            bool rehomed;
+        };
+
+        /**
+         * Constructs an AngleController at rest at 0 degrees.
+         *
+         * @param gains Controller and feedforward gains.
+         */
+        explicit AngleController(const Gains& gains);
+
+        /**
+         * Starts a profile from the current profiled state to a new goal.
+         *
+         * @param goal        Goal in degrees.
+         * @param now         Current time.
+         * @param maxVelocity Maximum velocity of the profile.
+         */
+        void SetGoal(double goal, units::second_t now,
+                     units::degrees_per_second_t maxVelocity = kMaxVelocity);
+
+        /**
+         * Resets the profile and controller to rest at an angle.
+         *
+         * @param now   Current time.
+         * @param angle Angle in degrees.
+         */
+        void Reset(units::second_t now, double angle = 0.0);
+
+        /**
+         * Returns the goal in degrees.
+         */
+        double GetGoal() const;
+
+        /**
+         * Runs one iteration of the controller.
+         *
+         * @param angle      Encoder angle in degrees.
+         * @param zeroSwitch Zero switch reading, which is false while pressed.
+         * @param now        Current time.
+         */
+        Output Calculate(double angle, bool zeroSwitch, units::second_t now);
+
+    private:
+        using AngleProfile = frc::TrapezoidProfile<units::degrees>;
+
+        double m_kK;
+        frc2::PIDController m_controller;
+
+        // The reference the profile is moving toward in degrees
+        double m_goal = 0.0;
+
+        AngleProfile m_profile{{kMaxVelocity, kMaxAcceleration}, {}, {}};
+        units::second_t m_profileStartTime = 0_s;
+
+        // Profiles from rest at each preset to every other preset, indexed by
+        // from * kPresets.size() + to
+        std::vector<AngleProfile> m_presetProfiles;
+
+        // kK divided by the goal, updated whenever the goal changes so the
+        // feedforward doesn't divide every iteration
+        double m_feedforwardScale = 0.0;
+    };
+
+    /**
+     * Constructs a Claw and starts its controller thread.
+     *
+     * @param schedule Scheduling settings for the controller thread.
+     */
+    explicit Claw(const frc3512::ThreadSchedule& schedule = {});
+
+    Claw(const Claw&) = delete;
+    Claw& operator=(const Claw&) = delete;
 
     /**
      * Set reference angle of claw.
+     *
+     * The controller adopts the new reference on its next iteration and moves
+     * to it along a trapezoid profile. Only one thread may call this,
+     * SetWheel() and Shoot() at a time.
      */
     void SetAngleReference(units::degree_t shooterAngle);
 
@@ -43,24 +250,130 @@ public:
     bool IsShooting() const;
 
     /**
-     * Code to run in TimedRobot::RobotPeriodic().
+     * Handles operator input. This should be run in
+     * TimedRobot::RobotPeriodic().
+     *
+     * @param input This cycle's operator input.
+     */
+    void RobotPeriodic(const frc3512::OperatorInput& input);
+
+    /**
+     * Returns cos(angle + kL) for an encoder angle in degrees.
+     *
+     * This interpolates a 1 degree table built at compile time, which is
+     * within 4e-5 of std::cos() over the claw's travel. Angles outside
+     * [kMinFeedforwardAngle, kMaxFeedforwardAngle] are clamped.
+     */
+    static double FeedforwardCos(double angle);
+
+    /**
+     * Publishes the controller thread's loop timing to NetworkTables.
+     */
+    void PublishLoopTiming();
+
+    /**
+     * Starts the self-test, which switches each shooter solenoid and the
+     * vacuum on and off in turn. Previous results are discarded.
+     */
+    void StartTest();
+
+    /**
+     * Advances the self-test if the current step's time is up. This never
+     * blocks, so it should be called every TestPeriodic().
+     *
+     * When the last step finishes, the results are printed.
+     */
+    void TestPeriodic();
+
+    /**
+     * Stops the self-test if it's running and switches off the actuator it was
+     * testing.
+     */
+    void StopTest();
+
+    /**
+     * Returns true if the self-test isn't running.
+     */
+    bool IsTestFinished() const;
+
+    /**
+     * Returns the self-test's results, indexed like the shooter solenoids with
+     * the vacuum last.
      */
-    void RobotPeriodic();
+    const std::array<ActuatorTestResult, kTestActuators>& GetTestResults()
+        const;
 
-    void TestClaw();
+    /**
+     * Returns the claw angle measured by the encoder.
+     */
+    units::degree_t GetAngle() const;
+
+    /**
+     * Moves the simulated arm to rest at an angle without changing the encoder
+     * reading, as if the encoder had drifted by the difference.
+     *
+     * This should only be called while the controller thread isn't running,
+     * e.g. with simulated time paused.
+     *
+     * @param angle Angle from the zero switch.
+     */
+    void SetSimulatedAngle(units::degree_t angle);
 
 private:
     enum class ShooterState { kIdle, kShooting, kVacuuming, kArmIsLifting };
 
-    static constexpr double kK = 0.238;
-    static constexpr double kL = 69.0;
+    // Collector arm commands the main thread hands to the controller thread
+    enum class CollectorRequest { kNone, kRetract, kToggle };
+
+    // Angles the operator's preset buttons select. Profiles between them are
+    // generated once at construction.
+    static constexpr std::array<double, 4> kPresets{0.0, 57.0, 106.0, 190.0};
+
+    /**
+     * Controller state published to other threads.
+     */
+    struct ControllerState {
+        /// Angle reference in degrees.
+        double reference = 0.0;
+
+        /// Generation of the last reference adopted from the mailbox.
+        uint32_t referenceGeneration = 0;
+    };
+
+    /**
+     * One step of the shooter sequence: the outputs to apply when entering
+     * the state and how long to stay in it.
+     */
+    struct ShooterStep {
+        ShooterState state;
+        units::second_t duration;
+        bool collectorArm;
+        bool shooter;
+        bool vacuum;
+    };
+
+    // The collector arm is lifted out of the way, the ball is shot, and then
+    // the vacuum holds the shooter pistons retracted
+    static constexpr std::array<ShooterStep, 3> kShooterSequence{
+        {{ShooterState::kArmIsLifting, 0.5_s, true, false, false},
+         {ShooterState::kShooting, 2_s, true, true, false},
+         {ShooterState::kVacuuming, 3_s, true, false, true}}};
+
+    // Outputs applied when the sequence finishes
+    static constexpr ShooterStep kShooterIdleStep{ShooterState::kIdle, 0_s,
+                                                  false, false, false};
 
     frc::Talon m_clawRotator{7};
     frc::Talon m_intakeWheel{8};
 
     frc::Encoder m_angleEncoder{7, 8};
 
-    frc2::PIDController m_controller{0.098, 0.08, 0.01};
+    // The last 40 ms of angle samples. Encoder::GetRate() differentiates a
+    // single period, which is too noisy at low speeds to gate the intake
+    // wheel.
+    frc3512::VelocityEstimator<8> m_angleVelocity;
+
+    AngleController m_controller{{kP, kI, kD, kK}};
 
     // Resets the angle encoder to 0
     frc::DigitalInput m_zeroSwitch{2};
@@ -68,12 +381,126 @@ private:
     // Returns true when ball is hitting limit switch in claw
     frc::DigitalInput m_haveBallSwitch{9};
 
-    frc2::Timer m_shootTimer;
-    ShooterState m_shooterState = ShooterState::kIdle;
+    // The simulated arm's angle is measured from horizontal, which is the
+    // encoder angle plus kL, so gravity acts on it the way the feedforward
+    // assumes. Its lower limit is the hard stop at the zero switch.
+    frc::sim::SingleJointedArmSim m_armSim{
+        frc::DCMotor::CIM(1),
+        kGearing,
+        frc::sim::SingleJointedArmSim::EstimateMOI(kArmLength, kArmMass),
+        kArmLength,
+        units::degree_t{kL},
+        units::degree_t{kL + kMaxFeedforwardAngle},
+        kArmMass,
+        true};
+    frc::sim::PWMSim m_clawRotatorSim{m_clawRotator};
+    frc::sim::EncoderSim m_angleEncoderSim{m_angleEncoder};
+    frc::sim::DIOSim m_zeroSwitchSim{m_zeroSwitch};
 
-    std::vector<frc::Solenoid> m_ballShooter;
+    // Written only by the shooter sequencer thread
+    std::atomic<ShooterState> m_shooterState{ShooterState::kIdle};
+    size_t m_shooterStep = 0;
+    units::second_t m_shooterDeadline = 0_s;
+
+    // The shooter's pistons fire in one PCM write so the ball is pushed
+    // evenly
+    frc3512::SolenoidGroup m_ballShooter{8, 2, 3, 6};
     frc::Relay m_vacuum{2, frc::Relay::kForwardOnly};
-    frc::Solenoid m_collectorArm{5};
+
+    // The shooter sequencer sets the collector arm for each step. Otherwise
+    // the controller thread sets it, with the main thread requesting changes
+    // through m_collectorRequest. Setting the arm to its current state doesn't
+    // write the PCM, so the two threads only contend when it moves.
+    frc3512::SolenoidGroup m_collectorArm{5};
+
+    // Self-test state. The test only runs on the main thread.
+    bool m_isTesting = false;
+    size_t m_testStep = 0;
+    units::second_t m_testStepStartTime = 0_s;
+    units::second_t m_testStepDeadline = 0_s;
+    std::array<ActuatorTestResult, kTestActuators> m_testResults;
 
     bool m_lastZeroSwitch = true;
+
+    // Reference mailbox. The writer stores the reference, then bumps the
+    // generation; the controller adopts the reference when the generation
+    // changes.
+    std::atomic<double> m_referenceRequest{0.0};
+    std::atomic<uint32_t> m_referenceGeneration{0};
+    uint32_t m_adoptedGeneration = 0;
+
+    std::atomic<double> m_wheelSpeed{0.0};
+
+    std::atomic<CollectorRequest> m_collectorRequest{CollectorRequest::kNone};
+
+    // Set by Shoot() and cleared once the sequencer has left the idle state
+    std::atomic<bool> m_shootRequested{false};
+
+    frc3512::SeqLock<ControllerState> m_state;
+
+    frc3512::ThreadSchedule m_schedule;
+    bool m_scheduleApplied = false;
+    bool m_shooterScheduleApplied = false;
+    frc3512::LoopTimer m_controllerTimer{"Claw controller", kDt};
+
+    // Declared last so the threads stop before anything they use is
+    // destroyed
+    frc::Notifier m_controllerThread{[this] { RunController(); }};
+
+    // Wakes at each shooter sequence transition's deadline
+    frc::Notifier m_shooterThread{[this] { RunShooterSequence(); }};
+
+    /**
+     * Runs one controller iteration on the controller thread.
+     */
+    void RunController();
+
+    /**
+     * Advances the arm simulation by one controller period using the last
+     * motor output, then updates the encoder and zero switch. Runs on the
+     * controller thread in simulation.
+     */
+    void UpdateSimulation();
+
+    /**
+     * Switches a self-test actuator.
+     *
+     * @param actuator Index into the self-test results.
+     * @param on       True to switch the actuator on.
+     */
+    void ApplyTestStep(size_t actuator, bool on);
+
+    /**
+     * Checks that a self-test actuator reads back in its commanded state
+     * without a fault. This is called at the end of each step since the PCM
+     * reports solenoid states in a periodic status frame. Actuators that
+     * aren't sensed are marked as such instead.
+     *
+     * @param actuator Index into the self-test results.
+     * @param on       The state it was commanded to.
+     */
+    void CheckTestStep(size_t actuator, bool on);
+
+    /**
+     * Prints a table of the self-test results.
+     */
+    void PrintTestResults() const;
+
+    /**
+     * Runs the angle controller and intake wheel.
+     */
+    void ControllerPeriodic();
+
+    /**
+     * Sets the collector arm from the main thread's requests and the zero
+     * switch, in that order. Runs on the controller thread.
+     */
+    void UpdateCollectorArm();
+
+    /**
+     * Starts the shooter sequence if a shot was requested, or advances it to
+     * the next step and schedules the step after that. Runs on the shooter
+     * sequencer thread.
+     */
+    void RunShooterSequence();
 };
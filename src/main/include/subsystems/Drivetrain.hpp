@@ -3,18 +3,32 @@
 #pragma once
 
 #include <frc/Encoder.h>
-#include <frc/Solenoid.h>
 #include <frc/SpeedControllerGroup.h>
 #include <frc/Talon.h>
 #include <frc/controller/ProfiledPIDController.h>
+#include <frc/controller/SimpleMotorFeedforward.h>
 #include <frc/drive/DifferentialDrive.h>
+#include <frc/simulation/EncoderSim.h>
 #include <frc/trajectory/TrapezoidProfile.h>
 #include <units/acceleration.h>
 #include <units/length.h>
+#include <units/time.h>
 #include <units/velocity.h>
+#include <units/voltage.h>
+
+#include "OperatorInput.hpp"
+#include "SolenoidGroup.hpp"
 
 class Drivetrain {
 public:
+    /// Period of ControllerPeriodic().
+    static constexpr units::second_t kDt = 20_ms;
+
+    /// Profile constraints. These leave voltage headroom for feedback at the
+    /// top speed the feedforward predicts.
+    static constexpr auto kMaxVelocity = 2.4_mps;
+    static constexpr auto kMaxAcceleration = 3_mps_sq;
+
     Drivetrain();
 
     void Drive(double xSpeed, double zRotation, bool isQuickTurn);
@@ -26,14 +40,56 @@ public:
 
     /**
      * Set left wheel position goal.
+     *
+     * Goals are encoder distances measured toward the front of the robot, the
+     * direction autonomous modes drive.
      */
     void SetLeftGoal(units::meter_t goal);
 
     /**
      * Set right wheel position goal.
+     *
+     * Goals are encoder distances measured toward the front of the robot, the
+     * direction autonomous modes drive.
      */
     void SetRightGoal(units::meter_t goal);
 
+    /**
+     * Starts driving each side to its goal along a trapezoid profile that
+     * begins where the side is now. Drive() shouldn't be called until
+     * DisableController().
+     */
+    void EnableController();
+
+    /**
+     * Stops driving to the goals and stops the motors.
+     */
+    void DisableController();
+
+    /**
+     * Returns true if the sides are being driven to their goals.
+     */
+    bool IsControllerEnabled() const;
+
+    /**
+     * Returns true if both sides' profiles have finished and they're within
+     * tolerance of their goals.
+     */
+    bool AtGoal() const;
+
+    /**
+     * Runs both sides' profiled controllers with feedforward if the controller
+     * is enabled. This should be called once per robot cycle after anything
+     * that sets the goals.
+     */
+    void ControllerPeriodic();
+
+    /**
+     * Returns how long the controller's profile takes to drive a side the
+     * given distance from rest.
+     */
+    static units::second_t GetProfileTime(units::meter_t distance);
+
     /**
      * Returns left encoder distance.
      */
@@ -44,22 +100,75 @@ public:
      */
     units::inch_t GetRightDist() const;
 
+    /**
+     * Returns the left gearbox's motor output from -1 to 1.
+     */
+    double GetLeftOutput() const;
+
+    /**
+     * Returns the right gearbox's motor output from -1 to 1.
+     */
+    double GetRightOutput() const;
+
+    /**
+     * Sets the encoder distances reported in simulation.
+     */
+    void SetSimulatedDistances(units::inch_t left, units::inch_t right);
+
     /**
      * Code to run in TimedRobot::TeleopPeriodic().
+     *
+     * @param input This cycle's operator input.
      */
-    void TeleopPeriodic();
+    void TeleopPeriodic(const frc3512::OperatorInput& input);
+
+    /**
+     * Advances a simple model of the drivetrain in which each side moves at a
+     * speed proportional to its motor output, then updates the simulated
+     * encoders.
+     *
+     * @param dt Time since the last call.
+     */
+    void SimulationPeriodic(units::second_t dt);
 
 private:
+    // Approximate top speed at full output, used by the simulation model
+    static constexpr auto kMaxSpeed = 10_fps;
+
+    // Feedforward gains. kS and kA are estimates until the drivetrain is
+    // characterized, and kV is chosen so 12 V reaches kMaxSpeed.
+    static constexpr auto kS = 1_V;
+    static constexpr auto kV = (12_V - kS) / kMaxSpeed;
+    static constexpr auto kA = 0.4_V / 1_mps_sq;
+
+    // Feedback gain in volts per meter of error
+    static constexpr double kP = 8.0;
+
+    // AtGoal() tolerances
+    static constexpr auto kPositionTolerance = 1_in;
+    static constexpr auto kVelocityTolerance = 0.1_mps;
+
     bool m_isDefensive = false;
     frc::Encoder m_leftEncoder{5, 6, true};
     frc::Encoder m_rightEncoder{3, 4};
+    frc::sim::EncoderSim m_leftEncoderSim{m_leftEncoder};
+    frc::sim::EncoderSim m_rightEncoderSim{m_rightEncoder};
 
-    frc::Solenoid m_shifter{7};
+    // On the same PCM as the claw's solenoids, so it has to be a group too
+    frc3512::SolenoidGroup m_shifter{7};
 
     frc::ProfiledPIDController<units::meter> m_leftController{
-        0.2, 0, 0, {5_mps, 10_mps_sq}};
+        kP, 0, 0, {kMaxVelocity, kMaxAcceleration}, kDt};
     frc::ProfiledPIDController<units::meter> m_rightController{
-        0.2, 0, 0, {5_mps, 10_mps_sq}};
+        kP, 0, 0, {kMaxVelocity, kMaxAcceleration}, kDt};
+    frc::SimpleMotorFeedforward<units::meter> m_feedforward{kS, kV, kA};
+
+    bool m_isControllerEnabled = false;
+
+    // Each side's setpoint velocity from the last cycle, from which the
+    // feedforward's acceleration is computed
+    units::meters_per_second_t m_lastLeftVelocity = 0_mps;
+    units::meters_per_second_t m_lastRightVelocity = 0_mps;
 
     frc::Talon m_fl{1};
     frc::Talon m_ml{2};
@@ -72,4 +181,18 @@ private:
     frc::SpeedControllerGroup m_rightGrbx{m_fr, m_mr, m_rr};
 
     frc::DifferentialDrive m_robotDrive{m_leftGrbx, m_rightGrbx};
+
+    /**
+     * Returns the voltage that moves one side along its profile: the
+     * feedforward for the profile's next setpoint plus the feedback
+     * correction.
+     *
+     * @param controller   The side's controller.
+     * @param position     The side's distance toward the front of the robot.
+     * @param lastVelocity The side's setpoint velocity from the last cycle.
+     *                     This is updated to the new setpoint's velocity.
+     */
+    units::volt_t CalculateSide(
+        frc::ProfiledPIDController<units::meter>& controller,
+        units::meter_t position, units::meters_per_second_t& lastVelocity);
 };
@@ -0,0 +1,103 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <cstdio>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <units/angle.h>
+#include <units/length.h>
+#include <units/time.h>
+
+#include "RobotSimHarness.hpp"
+
+// A full autonomous period is 15 seconds
+static constexpr auto kAutonomousDuration = 15_s;
+
+TEST(AutonomousSimTest, DriveForward) {
+    RobotSimHarness harness;
+    harness.StartAutonomous("DriveForward Autonomous");
+    harness.Step(kAutonomousDuration);
+    harness.Disable();
+    harness.Step(20_ms);
+
+    // 0.5 s at 10% then 0.5 s at 50% of 120 in/s
+    EXPECT_NEAR(36.0,
+                harness.GetRobot().GetDrivetrain().GetRightDist().to<double>(),
+                5.0);
+}
+
+TEST(AutonomousSimTest, RightLeft) {
+    RobotSimHarness harness;
+    harness.StartAutonomous("Right/Left Autonomous");
+    harness.Step(kAutonomousDuration);
+    harness.Disable();
+    harness.Step(20_ms);
+
+    const auto& robot = harness.GetRobot();
+    EXPECT_EQ(115_deg, robot.GetClaw().GetAngleReference());
+
+    // Both sides are driven to the 295 inch target closed-loop, so they reach
+    // it and finish level
+    const auto& drivetrain = robot.GetDrivetrain();
+    EXPECT_GT(drivetrain.GetRightDist(), 294_in);
+    EXPECT_NEAR(drivetrain.GetRightDist().to<double>(),
+                -drivetrain.GetLeftDist().to<double>(), 1.0);
+}
+
+TEST(AutonomousSimTest, Side) {
+    RobotSimHarness harness;
+    harness.StartAutonomous("Side Auton");
+    harness.Step(kAutonomousDuration);
+    harness.Disable();
+    harness.Step(20_ms);
+
+    const auto& drivetrain = harness.GetRobot().GetDrivetrain();
+    EXPECT_GT(drivetrain.GetRightDist(), 429_in);
+    EXPECT_NEAR(drivetrain.GetRightDist().to<double>(),
+                -drivetrain.GetLeftDist().to<double>(), 1.0);
+}
+
+TEST(AutonomousSimTest, ReplayMatchesRecording) {
+    std::string path;
+    {
+        RobotSimHarness harness;
+        harness.StartAutonomous("Right/Left Autonomous");
+        harness.Step(kAutonomousDuration);
+        harness.Disable();
+        harness.Step(20_ms);
+        path = harness.GetRobot().WaitForAutonomousLog();
+    }
+    ASSERT_FALSE(path.empty());
+
+    // The replay starts from the same simulated time as the recording, so
+    // the claw controller runs in the same phase and the outputs match
+    RobotSimHarness harness{false};
+    auto result =
+        harness.GetRobot().ReplayAutonomous("Right/Left Autonomous", path);
+    std::remove(path.c_str());
+
+    // 50 Hz for the whole autonomous period
+    EXPECT_NEAR(750.0, result.frames, 2.0);
+    EXPECT_EQ(0u, result.mismatchedFrames);
+    EXPECT_LT(result.maxOutputError, 1e-4);
+}
+
+TEST(AutonomousSimTest, LogsAreNotOverwritten) {
+    RobotSimHarness harness;
+    auto& robot = harness.GetRobot();
+
+    std::string paths[2];
+    for (auto& path : paths) {
+        harness.StartAutonomous("DriveForward Autonomous");
+        harness.Step(100_ms);
+        harness.Disable();
+        harness.Step(20_ms);
+        path = robot.WaitForAutonomousLog();
+    }
+
+    EXPECT_FALSE(paths[0].empty());
+    EXPECT_NE(paths[0], paths[1]);
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+    }
+}
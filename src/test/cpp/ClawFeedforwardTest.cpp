@@ -0,0 +1,40 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <wpi/math>
+
+#include "InterpolatingTable.hpp"
+#include "subsystems/Claw.hpp"
+
+static double LibmCos(double angle) {
+    return std::cos((angle + Claw::kL) * wpi::math::pi / 180.0);
+}
+
+TEST(ClawFeedforwardTest, ConstexprCosMatchesLibm) {
+    for (double x = -20.0; x <= 20.0; x += 0.001) {
+        EXPECT_NEAR(std::cos(x), frc3512::ConstexprCos(x), 1e-12) << x;
+    }
+}
+
+TEST(ClawFeedforwardTest, TableMatchesLibmOverTravel) {
+    double maxError = 0.0;
+    for (double angle = Claw::kMinFeedforwardAngle;
+         angle <= Claw::kMaxFeedforwardAngle; angle += 0.01) {
+        maxError = std::max(
+            maxError, std::abs(Claw::FeedforwardCos(angle) - LibmCos(angle)));
+    }
+
+    // Linear interpolation with 1 degree spacing is within
+    // (pi / 180)^2 / 8 = 3.8e-5 of the true value
+    EXPECT_LT(maxError, 4e-5);
+}
+
+TEST(ClawFeedforwardTest, TableClampsOutsideTravel) {
+    EXPECT_DOUBLE_EQ(Claw::FeedforwardCos(Claw::kMinFeedforwardAngle),
+                     Claw::FeedforwardCos(Claw::kMinFeedforwardAngle - 90.0));
+    EXPECT_DOUBLE_EQ(Claw::FeedforwardCos(Claw::kMaxFeedforwardAngle),
+                     Claw::FeedforwardCos(Claw::kMaxFeedforwardAngle + 90.0));
+}
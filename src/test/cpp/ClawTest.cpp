@@ -0,0 +1,166 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include <frc/simulation/PCMSim.h>
+#include <frc/simulation/RelaySim.h>
+#include <frc/simulation/SimHooks.h>
+#include <gtest/gtest.h>
+#include <units/angle.h>
+#include <units/time.h>
+
+#include "subsystems/Claw.hpp"
+
+class ClawTest : public testing::Test {
+protected:
+    std::unique_ptr<Claw> m_claw;
+
+    ClawTest() {
+        // Timing is paused before the claw starts its controller thread so
+        // every controller iteration happens inside StepTiming()
+        frc::sim::PauseTiming();
+        frc::sim::RestartTiming();
+        m_claw = std::make_unique<Claw>();
+    }
+
+    ~ClawTest() override {
+        m_claw.reset();
+        frc::sim::ResumeTiming();
+    }
+};
+
+TEST_F(ClawTest, MovesToPresets) {
+    for (auto reference : {57_deg, 106_deg, 190_deg}) {
+        m_claw->SetAngleReference(reference);
+        frc::sim::StepTiming(5_s);
+
+        EXPECT_NEAR(reference.to<double>(), m_claw->GetAngle().to<double>(),
+                    2.0);
+    }
+}
+
+TEST_F(ClawTest, RehomesAfterEncoderDrift) {
+    frc::sim::StepTiming(0.5_s);
+    EXPECT_NEAR(0.0, m_claw->GetAngle().to<double>(), 0.5);
+
+    // The arm is 20 degrees above the zero switch while the encoder still
+    // reads zero, so the re-homing logic should drive it down until the
+    // switch trips and the encoder is reset
+    m_claw->SetSimulatedAngle(20_deg);
+    EXPECT_EQ(0_deg, m_claw->GetAngle());
+
+    // The reference may drop to the re-homing goal, but no further
+    auto lowestReference = 0_deg;
+    for (int i = 0; i < 100; ++i) {
+        frc::sim::StepTiming(20_ms);
+        lowestReference =
+            std::min(lowestReference, m_claw->GetAngleReference());
+    }
+
+    EXPECT_GE(lowestReference.to<double>(), Claw::kRehomeGoal);
+    EXPECT_EQ(0_deg, m_claw->GetAngleReference());
+    EXPECT_NEAR(0.0, m_claw->GetAngle().to<double>(), 0.5);
+}
+
+TEST_F(ClawTest, ShootStepsThroughSequence) {
+    // Channels the claw's solenoids and vacuum relay are wired to
+    constexpr int kCollectorArm = 5;
+    constexpr std::array kShooter{2, 3, 6};
+    constexpr int kVacuum = 2;
+
+    frc::sim::PCMSim pcm;
+    frc::sim::RelaySim vacuum{kVacuum};
+
+    auto expectOutputs = [&](bool collectorArm, bool shooter, bool vacuumOn) {
+        EXPECT_EQ(collectorArm, pcm.GetSolenoidOutput(kCollectorArm));
+        for (int channel : kShooter) {
+            EXPECT_EQ(shooter, pcm.GetSolenoidOutput(channel))
+                << "shooter solenoid " << channel;
+        }
+        EXPECT_EQ(vacuumOn, vacuum.GetForward());
+    };
+
+    m_claw->Shoot();
+    EXPECT_TRUE(m_claw->IsShooting());
+
+    // The arm lifts for 0.5 s
+    frc::sim::StepTiming(0.25_s);
+    expectOutputs(true, false, false);
+
+    // The shooter fires for 2 s
+    frc::sim::StepTiming(0.5_s);
+    EXPECT_TRUE(m_claw->IsShooting());
+    expectOutputs(true, true, false);
+
+    // The vacuum retracts the shooter for 3 s
+    frc::sim::StepTiming(2_s);
+    EXPECT_TRUE(m_claw->IsShooting());
+    expectOutputs(true, false, true);
+
+    // Everything is switched off when the sequence finishes
+    frc::sim::StepTiming(3_s);
+    EXPECT_FALSE(m_claw->IsShooting());
+    expectOutputs(false, false, false);
+}
+
+TEST_F(ClawTest, CollectorArmMovesWithShooterSteps) {
+    constexpr int kCollectorArm = 5;
+
+    frc::sim::PCMSim pcm;
+
+    // Offset the shot from the 5 ms controller period so the controller
+    // hasn't run between each step's deadline and the checks below
+    frc::sim::StepTiming(2_ms);
+    m_claw->Shoot();
+
+    frc::sim::StepTiming(1_ms);
+    EXPECT_TRUE(pcm.GetSolenoidOutput(kCollectorArm));
+
+    frc::sim::StepTiming(5.5_s);
+    EXPECT_FALSE(m_claw->IsShooting());
+    EXPECT_FALSE(pcm.GetSolenoidOutput(kCollectorArm));
+}
+
+TEST_F(ClawTest, SelfTestRunsWithoutBlocking) {
+    m_claw->StartTest();
+
+    // Sixteen steps of 1.5 s each, advanced once per 20 ms robot cycle
+    int cycles = 0;
+    while (!m_claw->IsTestFinished() && cycles < 1500) {
+        m_claw->TestPeriodic();
+        frc::sim::StepTiming(20_ms);
+        ++cycles;
+    }
+
+    EXPECT_TRUE(m_claw->IsTestFinished());
+    EXPECT_NEAR(16 * 1.5 / 0.02, cycles, 16.0);
+
+    const auto& results = m_claw->GetTestResults();
+    for (const auto& result : results) {
+        EXPECT_TRUE(result.tested);
+        EXPECT_NEAR(Claw::kTestStepDuration.to<double>(),
+                    result.onTime.to<double>(), 0.03);
+    }
+
+    // The first shooter solenoid is on channel 8, which is out of the PCM's
+    // range, so it can never read back as energized
+    EXPECT_FALSE(results[0].passed);
+    for (size_t i = 1; i < Claw::kTestActuators - 1; ++i) {
+        EXPECT_TRUE(results[i].passed) << "shooter solenoid " << i;
+    }
+
+    // Nothing senses the vacuum, so it's switched but never graded as passing
+    EXPECT_FALSE(results[Claw::kTestActuators - 1].sensed);
+    EXPECT_FALSE(results[Claw::kTestActuators - 1].passed);
+}
+
+TEST_F(ClawTest, SelfTestStopsWhenDisabled) {
+    m_claw->StartTest();
+    m_claw->TestPeriodic();
+    m_claw->StopTest();
+
+    EXPECT_TRUE(m_claw->IsTestFinished());
+    EXPECT_FALSE(m_claw->GetTestResults()[0].tested);
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <algorithm>
+
+#include <frc/simulation/SimHooks.h>
+#include <gtest/gtest.h>
+#include <units/length.h>
+#include <units/time.h>
+
+#include "subsystems/Drivetrain.hpp"
+
+class DrivetrainTest : public testing::Test {
+protected:
+    Drivetrain m_drivetrain;
+
+    DrivetrainTest() { frc::sim::PauseTiming(); }
+
+    ~DrivetrainTest() override { frc::sim::ResumeTiming(); }
+
+    /**
+     * Drives both sides to a goal and returns the time it took, or a negative
+     * time if it wasn't reached within 10 s.
+     *
+     * @param goal        Goal for both sides.
+     * @param maxDistance Set to the farthest distance either side reached.
+     */
+    units::second_t DriveTo(units::inch_t goal, units::inch_t& maxDistance) {
+        m_drivetrain.SetLeftGoal(goal);
+        m_drivetrain.SetRightGoal(goal);
+        m_drivetrain.EnableController();
+
+        maxDistance = 0_in;
+        for (int i = 0; i < 500; ++i) {
+            if (m_drivetrain.AtGoal()) {
+                m_drivetrain.DisableController();
+                return i * Drivetrain::kDt;
+            }
+
+            m_drivetrain.ControllerPeriodic();
+            m_drivetrain.SimulationPeriodic(Drivetrain::kDt);
+            frc::sim::StepTiming(Drivetrain::kDt);
+
+            maxDistance = std::max({maxDistance, -m_drivetrain.GetLeftDist(),
+                                    m_drivetrain.GetRightDist()});
+        }
+
+        m_drivetrain.DisableController();
+        return -1_s;
+    }
+};
+
+TEST_F(DrivetrainTest, ReachesGoalsInProfileTimeWithoutOvershoot) {
+    // Trapezoid profile durations for each distance at the drivetrain's
+    // constraints
+    for (auto [goal, profileTime] : {std::pair{295_in, 3.92_s},
+                                     std::pair{430_in, 5.35_s}}) {
+        m_drivetrain.ResetEncoders();
+
+        units::inch_t maxDistance;
+        auto time = DriveTo(goal, maxDistance);
+
+        EXPECT_GT(time, profileTime - 0.2_s) << goal.to<double>();
+        EXPECT_LT(time, profileTime + 0.4_s) << goal.to<double>();
+        EXPECT_LT(maxDistance, goal + 0.5_in) << goal.to<double>();
+        EXPECT_NEAR(goal.to<double>(), m_drivetrain.GetRightDist().to<double>(),
+                    1.0);
+        EXPECT_NEAR(goal.to<double>(), -m_drivetrain.GetLeftDist().to<double>(),
+                    1.0);
+    }
+}
+
+TEST_F(DrivetrainTest, PushesPastStaticFrictionWhenStalledShortOfGoal) {
+    // Proportional feedback alone is below the assumed 1 V of static friction
+    // at this error
+    constexpr auto kGoal = 3_in;
+
+    m_drivetrain.ResetEncoders();
+    m_drivetrain.SetLeftGoal(kGoal);
+    m_drivetrain.SetRightGoal(kGoal);
+    m_drivetrain.EnableController();
+
+    // Run past the end of the profile without the drivetrain moving
+    int steps = (Drivetrain::GetProfileTime(kGoal) + 0.5_s) / Drivetrain::kDt;
+    for (int i = 0; i < steps; ++i) {
+        m_drivetrain.ControllerPeriodic();
+        frc::sim::StepTiming(Drivetrain::kDt);
+    }
+
+    EXPECT_FALSE(m_drivetrain.AtGoal());
+    EXPECT_GT(m_drivetrain.GetRightOutput(), 1.0 / 12.0);
+    EXPECT_LT(m_drivetrain.GetLeftOutput(), -1.0 / 12.0);
+
+    m_drivetrain.DisableController();
+}
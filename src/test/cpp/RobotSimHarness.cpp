@@ -0,0 +1,57 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "RobotSimHarness.hpp"
+
+#include <frc/simulation/DriverStationSim.h>
+#include <frc/simulation/SimHooks.h>
+
+RobotSimHarness::RobotSimHarness(bool runMainLoop) {
+    frc::sim::PauseTiming();
+    frc::sim::RestartTiming();
+
+    SetDriverStationState(false, false);
+
+    // Each test constructs its own Robot, so its startup phases shouldn't be
+    // appended to the previous one's
+    frc3512::StartupProfiler::Reset();
+    m_robot = std::make_unique<Robot>();
+    if (!runMainLoop) {
+        return;
+    }
+    m_robotThread = std::thread{[this] { m_robot->StartCompetition(); }};
+
+    // Let the main loop reach its first wait so Step() starts from a known
+    // point
+    Step(0_s);
+}
+
+RobotSimHarness::~RobotSimHarness() {
+    if (m_robotThread.joinable()) {
+        m_robot->EndCompetition();
+        m_robotThread.join();
+    }
+    m_robot.reset();
+
+    frc::sim::DriverStationSim::ResetData();
+    frc::sim::ResumeTiming();
+}
+
+Robot& RobotSimHarness::GetRobot() { return *m_robot; }
+
+void RobotSimHarness::StartAutonomous(std::string_view name) {
+    m_robot->SelectAutonomous(name);
+    SetDriverStationState(true, true);
+}
+
+void RobotSimHarness::Disable() { SetDriverStationState(false, false); }
+
+void RobotSimHarness::Step(units::second_t duration) {
+    frc::sim::StepTiming(duration);
+}
+
+void RobotSimHarness::SetDriverStationState(bool enabled, bool autonomous) {
+    frc::sim::DriverStationSim::SetDsAttached(true);
+    frc::sim::DriverStationSim::SetAutonomous(autonomous);
+    frc::sim::DriverStationSim::SetEnabled(enabled);
+    frc::sim::DriverStationSim::NotifyNewData();
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <gtest/gtest.h>
+#include <units/time.h>
+
+#include "VelocityEstimator.hpp"
+
+TEST(VelocityEstimatorTest, ZeroWithoutTwoSamples) {
+    frc3512::VelocityEstimator<4> estimator;
+    EXPECT_EQ(0.0, estimator.LeastSquaresSlope());
+
+    estimator.Add(1_s, 5.0);
+    EXPECT_EQ(0.0, estimator.MovingAverage());
+    EXPECT_EQ(0.0, estimator.Median());
+    EXPECT_EQ(0.0, estimator.LeastSquaresSlope());
+}
+
+TEST(VelocityEstimatorTest, ConstantVelocityWithJitteredTimestamps) {
+    frc3512::VelocityEstimator<8> estimator;
+
+    // 40 units/s sampled at an uneven period far from the epoch
+    double t = 1000.0;
+    for (int i = 0; i < 20; ++i) {
+        t += (i % 3 == 0) ? 0.004 : 0.006;
+        estimator.Add(units::second_t{t}, 40.0 * t);
+    }
+
+    EXPECT_EQ(8u, estimator.Size());
+    EXPECT_NEAR(40.0, estimator.MovingAverage(), 1e-6);
+    EXPECT_NEAR(40.0, estimator.Median(), 1e-6);
+    EXPECT_NEAR(40.0, estimator.LeastSquaresSlope(), 1e-6);
+}
+
+TEST(VelocityEstimatorTest, MedianRejectsOutlier) {
+    frc3512::VelocityEstimator<6> estimator;
+    for (int i = 0; i < 6; ++i) {
+        double position = 10.0 * i;
+        if (i == 3) {
+            position += 5.0;
+        }
+        estimator.Add(units::second_t{i * 0.1}, position);
+    }
+
+    // Rates are 100, 100, 150, 50, 100
+    EXPECT_DOUBLE_EQ(100.0, estimator.Median());
+}
+
+TEST(VelocityEstimatorTest, ClearDiscardsSamples) {
+    frc3512::VelocityEstimator<4> estimator;
+    estimator.Add(0_s, 0.0);
+    estimator.Add(1_s, 10.0);
+    estimator.Clear();
+
+    EXPECT_EQ(0u, estimator.Size());
+    estimator.Add(2_s, 0.0);
+    estimator.Add(3_s, -3.0);
+    EXPECT_DOUBLE_EQ(-3.0, estimator.LeastSquaresSlope());
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <thread>
+
+#include <units/time.h>
+
+#include "Robot.hpp"
+
+/**
+ * Runs Robot against the HAL simulator with simulated time paused, so tests
+ * can advance time as fast as the robot code runs instead of at wall-clock
+ * speed.
+ *
+ * The robot's main loop runs on a separate thread. Step() returns only once
+ * every Notifier due in the stepped interval has run, so the robot is idle
+ * whenever the test thread inspects it.
+ */
+class RobotSimHarness {
+public:
+    /**
+     * Pauses simulated time, constructs Robot and starts its main loop in
+     * disabled mode.
+     *
+     * @param runMainLoop Whether to start the main loop. Without it, tests
+     *                    drive the robot themselves, e.g. with
+     *                    Robot::ReplayAutonomous().
+     */
+    explicit RobotSimHarness(bool runMainLoop = true);
+
+    /**
+     * Stops the main loop if it's running, destroys Robot and resumes
+     * simulated time.
+     */
+    ~RobotSimHarness();
+
+    RobotSimHarness(const RobotSimHarness&) = delete;
+    RobotSimHarness& operator=(const RobotSimHarness&) = delete;
+
+    /**
+     * Returns the robot under test.
+     */
+    Robot& GetRobot();
+
+    /**
+     * Selects an autonomous mode and enables the robot in autonomous.
+     *
+     * @param name Name of autonomous mode.
+     */
+    void StartAutonomous(std::string_view name);
+
+    /**
+     * Disables the robot.
+     */
+    void Disable();
+
+    /**
+     * Advances simulated time.
+     *
+     * @param duration Amount of simulated time to run the robot for.
+     */
+    void Step(units::second_t duration);
+
+private:
+    std::unique_ptr<Robot> m_robot;
+    std::thread m_robotThread;
+
+    /**
+     * Publishes the driver station state and waits for the robot to see it.
+     */
+    void SetDriverStationState(bool enabled, bool autonomous);
+};
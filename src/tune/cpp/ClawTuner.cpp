@@ -0,0 +1,231 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "ClawTuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <frc/StateSpaceUtil.h>
+#include <frc/simulation/SingleJointedArmSim.h>
+#include <frc/system/plant/DCMotor.h>
+#include <frc/trajectory/TrapezoidProfile.h>
+#include <units/angle.h>
+#include <units/voltage.h>
+#include <wpi/raw_ostream.h>
+
+namespace frc3512::tune {
+
+// Time spent holding the starting angle before the move so the integrator
+// reaches steady state like it would on the robot
+static constexpr auto kHoldTime = 1_s;
+
+// Time after the profile finishes allowed for the claw to settle
+static constexpr auto kSettleWindow = 2_s;
+
+// Half-width of the band around the goal the claw must stay within to count
+// as settled
+static constexpr double kSettlingBand = 1.0;
+
+// Seconds of cost per degree of overshoot. Overshooting the stops slams the
+// claw, so this is weighted heavily.
+static constexpr double kOvershootCost = 0.1;
+
+// Battery voltage assumed for the model
+static constexpr auto kBatteryVoltage = 12_V;
+
+// Multiplicative steps applied to each gain per search round. Each round
+// narrows around the previous round's best gains.
+static constexpr std::array<std::array<double, 5>, 3> kSearchSteps{
+    {{0.25, 0.5, 1.0, 2.0, 4.0},
+     {0.6, 0.8, 1.0, 1.25, 1.6},
+     {0.85, 0.92, 1.0, 1.08, 1.17}}};
+
+double ClawMoveResult::Cost() const {
+    double cost = riseTime + kOvershootCost * overshoot + settlingTime;
+    if (!settled) {
+        cost *= 2.0;
+    }
+    return cost;
+}
+
+ClawMoveResult SimulateClawMove(const ClawGains& gains, const ClawMove& move) {
+    frc::sim::SingleJointedArmSim arm{
+        frc::DCMotor::CIM(1),
+        Claw::kGearing,
+        frc::sim::SingleJointedArmSim::EstimateMOI(Claw::kArmLength,
+                                                   Claw::kArmMass),
+        Claw::kArmLength,
+        units::degree_t{Claw::kL},
+        units::degree_t{Claw::kL + Claw::kMaxFeedforwardAngle},
+        Claw::kArmMass,
+        true};
+    units::radian_t startAngle = units::degree_t{move.from + Claw::kL};
+    arm.SetState(frc::MakeMatrix<2, 1>(startAngle.to<double>(), 0.0));
+
+    // Time starts at -kHoldTime so the move starts at zero
+    Claw::AngleController controller{gains};
+    controller.Reset(-kHoldTime, move.from);
+
+    // Claw resets its encoder when the controller re-homes, after which the
+    // encoder reads the arm's angle minus this offset
+    double encoderOffset = 0.0;
+
+    double distance = move.to - move.from;
+    int holdSteps = kHoldTime / Claw::kDt;
+
+    // The move is simulated for as long as the controller's profile takes,
+    // plus time to settle
+    frc::TrapezoidProfile<units::degrees> profile{
+        {Claw::kMaxVelocity, Claw::kMaxAcceleration},
+        {units::degree_t{move.to}, 0_deg_per_s},
+        {units::degree_t{move.from}, 0_deg_per_s}};
+    int moveSteps = (profile.TotalTime() + kSettleWindow) / Claw::kDt;
+
+    ClawMoveResult result;
+    double riseStart = -1.0;
+    double riseEnd = -1.0;
+    double lastOutsideBand = 0.0;
+
+    for (int i = -holdSteps; i < moveSteps; ++i) {
+        units::second_t now = i * Claw::kDt;
+        double t = now.to<double>();
+        double angle = units::degree_t{arm.GetAngle()}.to<double>() - Claw::kL;
+
+        if (i == 0) {
+            controller.SetGoal(move.to, now);
+        }
+
+        if (i >= 0) {
+            double progress = (angle - move.from) / distance;
+            if (riseStart < 0.0 && progress >= 0.1) {
+                riseStart = t;
+            }
+            if (riseEnd < 0.0 && progress >= 0.9) {
+                riseEnd = t;
+            }
+            result.overshoot = std::max(result.overshoot,
+                                        (progress - 1.0) * std::abs(distance));
+            if (std::abs(angle - move.to) > kSettlingBand) {
+                lastOutsideBand = t + Claw::kDt.to<double>();
+            }
+        }
+
+        // The zero switch reads false while pressed, as in Claw's simulation
+        double encoderAngle = angle - encoderOffset;
+        auto output =
+            controller.Calculate(encoderAngle, !arm.HasHitLowerLimit(), now);
+        if (output.rehomed) {
+            encoderOffset += encoderAngle;
+        }
+
+        // Talon::Set() clamps its input the same way
+        double motor = std::clamp(output.motor, -1.0, 1.0);
+        arm.SetInputVoltage(motor * kBatteryVoltage);
+        arm.Update(Claw::kDt);
+    }
+
+    double duration = (moveSteps * Claw::kDt).to<double>();
+    if (riseStart >= 0.0 && riseEnd >= 0.0) {
+        result.riseTime = riseEnd - riseStart;
+    } else {
+        result.riseTime = duration;
+    }
+    result.settlingTime = lastOutsideBand;
+    result.settled = lastOutsideBand < duration;
+
+    return result;
+}
+
+double ClawCost(const ClawGains& gains) {
+    double cost = 0.0;
+    for (const auto& move : kClawMoves) {
+        cost += SimulateClawMove(gains, move).Cost();
+    }
+    return cost;
+}
+
+ClawGains TuneClaw(WorkStealingPool& pool) {
+    ClawGains best{Claw::kP, Claw::kI, Claw::kD, Claw::kK};
+    double bestCost = ClawCost(best);
+
+    wpi::outs() << "Evaluating candidates on " << pool.GetThreadCount()
+                << " threads\n";
+
+    std::vector<ClawGains> candidates;
+    std::vector<double> costs;
+
+    for (size_t round = 0; round < kSearchSteps.size(); ++round) {
+        const auto& steps = kSearchSteps[round];
+
+        candidates.clear();
+        for (double p : steps) {
+            for (double i : steps) {
+                for (double d : steps) {
+                    for (double k : steps) {
+                        candidates.emplace_back(ClawGains{
+                            best.kP * p, best.kI * i, best.kD * d,
+                            best.kK * k});
+                    }
+                }
+            }
+        }
+
+        // Each task writes only its own slot, so the results need no locking
+        costs.assign(candidates.size(), 0.0);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            pool.Submit([&, i] { costs[i] = ClawCost(candidates[i]); });
+        }
+        pool.Wait();
+
+        auto winner = std::min_element(costs.begin(), costs.end());
+        if (*winner < bestCost) {
+            bestCost = *winner;
+            best = candidates[winner - costs.begin()];
+        }
+
+        char line[128];
+        std::snprintf(line, sizeof(line),
+                      "Round %zu: %zu candidates, best cost %.3f\n", round + 1,
+                      candidates.size(), bestCost);
+        wpi::outs() << line;
+    }
+
+    return best;
+}
+
+void PrintClawMoves(const ClawGains& gains) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %10s %16s %14s\n", "move",
+                  "rise (s)", "overshoot (deg)", "settling (s)");
+    wpi::outs() << line;
+
+    for (const auto& move : kClawMoves) {
+        auto result = SimulateClawMove(gains, move);
+        std::snprintf(line, sizeof(line), "%5.0f -> %-5.0f %10.3f %16.2f ",
+                      move.from, move.to, result.riseTime, result.overshoot);
+        wpi::outs() << line;
+        if (result.settled) {
+            std::snprintf(line, sizeof(line), "%14.3f\n",
+                          result.settlingTime);
+            wpi::outs() << line;
+        } else {
+            wpi::outs() << "         never\n";
+        }
+    }
+}
+
+void PrintClawGains(const ClawGains& gains) {
+    char line[128];
+    wpi::outs() << "// Gains for Claw.hpp\n";
+    std::snprintf(line, sizeof(line),
+                  "static constexpr double kP = %.4g;\n"
+                  "static constexpr double kI = %.4g;\n"
+                  "static constexpr double kD = %.4g;\n"
+                  "static constexpr double kK = %.4g;\n",
+                  gains.kP, gains.kI, gains.kD, gains.kK);
+    wpi::outs() << line;
+}
+
+}  // namespace frc3512::tune
@@ -0,0 +1,26 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include <hal/HAL.h>
+#include <wpi/raw_ostream.h>
+
+#include "ClawTuner.hpp"
+#include "subsystems/Claw.hpp"
+
+int main() {
+    HAL_Initialize(500, 0);
+
+    frc3512::tune::ClawGains current{Claw::kP, Claw::kI, Claw::kD, Claw::kK};
+    wpi::outs() << "Current gains:\n";
+    frc3512::tune::PrintClawMoves(current);
+    wpi::outs() << '\n';
+
+    frc3512::tune::WorkStealingPool pool;
+    auto tuned = frc3512::tune::TuneClaw(pool);
+
+    wpi::outs() << "\nTuned gains:\n";
+    frc3512::tune::PrintClawMoves(tuned);
+    wpi::outs() << '\n';
+    frc3512::tune::PrintClawGains(tuned);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#include "WorkStealingPool.hpp"
+
+namespace frc3512::tune {
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    for (size_t i = 0; i < threads; ++i) {
+        m_queues.emplace_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this, i] { Run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::scoped_lock lock{m_mutex};
+        m_exiting = true;
+    }
+    m_workReady.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::Submit(std::function<void()> task) {
+    std::scoped_lock lock{m_mutex};
+
+    auto& queue = *m_queues[m_nextQueue];
+    m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+    {
+        std::scoped_lock queueLock{queue.mutex};
+        queue.tasks.emplace_back(std::move(task));
+        ++m_queued;
+    }
+
+    ++m_unfinished;
+    m_workReady.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+    std::unique_lock lock{m_mutex};
+    m_allDone.wait(lock, [this] { return m_unfinished == 0; });
+}
+
+size_t WorkStealingPool::GetThreadCount() const { return m_threads.size(); }
+
+bool WorkStealingPool::TryPop(size_t worker, std::function<void()>& task) {
+    {
+        auto& queue = *m_queues[worker];
+        std::scoped_lock lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        auto& victim = *m_queues[(worker + i) % m_queues.size()];
+        std::scoped_lock lock{victim.mutex};
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingPool::Run(size_t worker) {
+    std::function<void()> task;
+
+    while (true) {
+        if (TryPop(worker, task)) {
+            task();
+            task = nullptr;
+
+            std::scoped_lock lock{m_mutex};
+            if (--m_unfinished == 0) {
+                m_allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock lock{m_mutex};
+        m_workReady.wait(lock, [this] { return m_queued > 0 || m_exiting; });
+        if (m_exiting && m_queued == 0) {
+            return;
+        }
+    }
+}
+
+}  // namespace frc3512::tune
@@ -0,0 +1,87 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+
+#include "WorkStealingPool.hpp"
+#include "subsystems/Claw.hpp"
+
+namespace frc3512::tune {
+
+/**
+ * Gains for the claw's angle controller and feedforward.
+ */
+using ClawGains = Claw::AngleController::Gains;
+
+/**
+ * A setpoint move between two encoder angles in degrees.
+ */
+struct ClawMove {
+    double from;
+    double to;
+};
+
+/// Representative moves: a full swing up from the stop, a swing back down to
+/// a preset, and small nudges in each direction around it.
+inline constexpr std::array<ClawMove, 4> kClawMoves{
+    {{0.0, 190.0}, {190.0, 57.0}, {57.0, 60.0}, {60.0, 57.0}}};
+
+/**
+ * How a move's step response looked.
+ */
+struct ClawMoveResult {
+    /// Time in seconds to go from 10% to 90% of the move.
+    double riseTime = 0.0;
+
+    /// Largest excursion past the goal in degrees.
+    double overshoot = 0.0;
+
+    /// Time in seconds after which the claw stayed within the settling band
+    /// of the goal.
+    double settlingTime = 0.0;
+
+    /// False if the claw was outside the settling band at the end of the
+    /// simulation.
+    bool settled = false;
+
+    /**
+     * Returns the cost of this response. Lower is better.
+     */
+    double Cost() const;
+};
+
+/**
+ * Simulates the claw through a move with the given gains.
+ *
+ * This runs Claw::AngleController, the same controller Claw runs on the robot,
+ * every Claw::kDt against the arm model Claw uses in simulation mode. The
+ * encoder is reset whenever the controller re-homes, like Claw does.
+ */
+ClawMoveResult SimulateClawMove(const ClawGains& gains, const ClawMove& move);
+
+/**
+ * Returns the total cost of the gains over kClawMoves.
+ */
+double ClawCost(const ClawGains& gains);
+
+/**
+ * Searches for the gains with the lowest cost, starting from Claw's current
+ * gains.
+ *
+ * Each round evaluates a grid of candidates around the best gains so far,
+ * spread across the pool's threads, then narrows the grid around the winner.
+ */
+ClawGains TuneClaw(WorkStealingPool& pool);
+
+/**
+ * Prints each move's response with the given gains.
+ */
+void PrintClawMoves(const ClawGains& gains);
+
+/**
+ * Prints the gains as declarations that can be pasted into Claw.hpp.
+ */
+void PrintClawGains(const ClawGains& gains);
+
+}  // namespace frc3512::tune
@@ -0,0 +1,94 @@
+// Copyright (c) 2021 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+namespace frc3512::tune {
+
+/**
+ * A fixed set of worker threads that each own a task queue.
+ *
+ * Submitted tasks are dealt round-robin across the queues. A worker runs tasks
+ * from the back of its own queue and, once that's empty, steals from the front
+ * of the others, so workers that drew cheap tasks pick up the slack from ones
+ * that drew expensive tasks.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * Constructs a WorkStealingPool.
+     *
+     * @param threads Number of worker threads. Defaults to one per hardware
+     *                thread.
+     */
+    explicit WorkStealingPool(
+        size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Queues a task to run on a worker thread.
+     */
+    void Submit(std::function<void()> task);
+
+    /**
+     * Blocks until every submitted task has finished.
+     */
+    void Wait();
+
+    /**
+     * Returns the number of worker threads.
+     */
+    size_t GetThreadCount() const;
+
+private:
+    struct Queue {
+        wpi::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    // Guards sleeping and waking. Tasks are submitted under it so a worker
+    // can't miss a submission between finding the queues empty and going to
+    // sleep.
+    wpi::mutex m_mutex;
+    wpi::condition_variable m_workReady;
+    wpi::condition_variable m_allDone;
+
+    // Number of tasks in the queues. It's updated under the lock of the queue
+    // a task is pushed to or popped from, so it never counts a task that a
+    // worker has already taken, which would keep idle workers from sleeping.
+    std::atomic<size_t> m_queued{0};
+    size_t m_unfinished = 0;
+    size_t m_nextQueue = 0;
+    bool m_exiting = false;
+
+    /**
+     * Pops a task from the back of the worker's own queue, or steals one from
+     * the front of another worker's queue, and decrements m_queued.
+     *
+     * @return True if a task was found.
+     */
+    bool TryPop(size_t worker, std::function<void()>& task);
+
+    void Run(size_t worker);
+};
+
+}  // namespace frc3512::tune